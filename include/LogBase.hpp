@@ -9,12 +9,154 @@
 #define LOG_BASE_HPP
 
 // C++ Standard Libraries
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <deque>
+#include <memory_resource>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 
 namespace logging {
+	/**
+	 * 	@brief	Namespace threading holds the synchronisation types used by the logging classes. Defining 
+	 * 			LOGGING_SINGLE_THREADED before including any logging header replaces them with types that do 
+	 * 			nothing, for programs that only log from one thread, and the console then prints from the calling 
+	 * 			thread rather than a child thread.
+	 */
+	namespace threading {
+#ifdef LOGGING_SINGLE_THREADED
+		/// Flag for if the logging classes are built for a single thread.
+		constexpr bool SINGLE_THREADED = true;
+
+		/**
+		 * 	@brief	Struct null_mutex has the interface of std::mutex but does nothing.
+		 */
+		struct null_mutex {
+			void lock() noexcept {}
+			bool try_lock() noexcept { return true; }
+			void unlock() noexcept {}
+		};
+
+		/**
+		 * 	@class	plain_atomic
+		 * 	@brief	Class plain_atomic has the interface of std::atomic used by the logging classes, but holds its 
+		 * 			value as a plain variable.
+		 */
+		template <typename T>
+		class plain_atomic {
+		public:
+			constexpr plain_atomic() noexcept : value() {}
+			constexpr plain_atomic(T initial) noexcept : value(initial) {}
+			plain_atomic(const plain_atomic&) = delete;
+			void operator=(const plain_atomic&) = delete;
+
+			T load(std::memory_order = std::memory_order_seq_cst) const noexcept {
+				return value;
+			}
+			void store(T desired, std::memory_order = std::memory_order_seq_cst) noexcept {
+				value = desired;
+			}
+			T exchange(T desired, std::memory_order = std::memory_order_seq_cst) noexcept {
+				return std::exchange(value, desired);
+			}
+			bool compare_exchange_strong(T& expected, T desired, std::memory_order = std::memory_order_seq_cst) noexcept {
+				if (value == expected) {
+					value = desired;
+					return true;
+				}
+				expected = value;
+				return false;
+			}
+			T fetch_add(T operand, std::memory_order = std::memory_order_seq_cst) noexcept {
+				T previous = value;
+				value += operand;
+				return previous;
+			}
+			operator T() const noexcept {
+				return value;
+			}
+			T operator=(T desired) noexcept {
+				value = desired;
+				return desired;
+			}
+
+		private:
+			T value;
+		};
+
+		/**
+		 * 	@brief	Struct once_flag has the interface of std::once_flag, for call_once.
+		 */
+		struct once_flag {
+			bool called = false;
+		};
+
+		/**
+		 * 	@brief	Function call_once calls a function if it hasn't been called with the flag before, or if it 
+		 * 			threw when it was.
+		 * 	@param	flag 		once_flag flag for the function.
+		 * 	@param	function 	function to call.
+		 */
+		template <typename Function>
+		void call_once(once_flag& flag, Function&& function) {
+			if (!flag.called) {
+				std::forward<Function>(function)();
+				flag.called = true;
+			}
+		}
+
+		using mutex = null_mutex;
+		using spin_mutex = null_mutex;
+		template <typename T>
+		using atomic = plain_atomic<T>;
+		using condition_variable = std::condition_variable_any;
+#else
+		/// Flag for if the logging classes are built for a single thread.
+		constexpr bool SINGLE_THREADED = false;
+
+		/**
+		 * 	@class	spin_mutex
+		 * 	@brief	Class spin_mutex has the interface of std::mutex, but spins rather than sleeping while it is 
+		 * 			locked, for locks that are only held for a few instructions.
+		 */
+		class spin_mutex {
+		public:
+			void lock() noexcept {
+				while (locked.exchange(true, std::memory_order_acquire)) {
+					// Wait for the lock to be released without writing to it, yielding to the thread holding it.
+					while (locked.load(std::memory_order_relaxed)) {
+						std::this_thread::yield();
+					}
+				}
+			}
+			bool try_lock() noexcept {
+				return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+			}
+			void unlock() noexcept {
+				locked.store(false, std::memory_order_release);
+			}
+
+		private:
+			std::atomic<bool> locked{false};
+		};
+
+		using mutex = std::mutex;
+		template <typename T>
+		using atomic = std::atomic<T>;
+		using condition_variable = std::condition_variable;
+		using std::once_flag;
+		using std::call_once;
+#endif
+	}
+
 	/// Static template for message timestamps.
 	const static char time_template[] = "9999-12-31 29:59:59.9999";
 	/// Static width of message timestamps.
@@ -46,6 +188,14 @@ namespace logging {
 		}
 
 		operator std::string() const { 
+			return std::string(to_string_view());
+		}
+
+		/**
+		 * 	@brief 	Method to_string_view gets the name of the severity without allocating.
+		 * 	@return std::string_view name of the severity, or an empty view if it is unknown.
+		 */
+		constexpr std::string_view to_string_view() const {
 			switch(m_severity) {
 				case info:
 					return "INFO";
@@ -76,7 +226,7 @@ namespace logging {
 	 *	@note	If the original string does not contain the delimiter, a deque of one element containing 
 	 * 			the original string is returned.
 	 */
-	const std::deque<std::string> split_string(const std::string s, const std::string delimiter) {
+	inline const std::deque<std::string> split_string(const std::string s, const std::string delimiter) {
 		// Deque of tokens found in the string.
 		std::deque<std::string> tokens;
 		// Indices of tokens within the string.
@@ -104,64 +254,329 @@ namespace logging {
 		return tokens;
 	}
 
+	/**
+	 * 	@brief	Function write_timestamp writes a timestamp for messages into a buffer, without allocating.
+	 * 	@param 	buffer 	char array to write the null-terminated timestamp to.
+	 * 	@param 	time 	std::chrono::system_clock::time_point time of the timestamp, which defaults to now.
+	 * 	@return size_t length of the timestamp in characters.
+	 * 	@note	The date and time up to the second is cached per thread, so the calendar conversion is only 
+	 * 			done once a second in each thread.
+	 */
+	inline size_t write_timestamp(
+		char (&buffer)[time_template_width], 
+		std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) 
+	{
+		// Split the time into whole seconds and milliseconds.
+		auto since_epoch = time.time_since_epoch();
+		auto seconds = std::chrono::floor<std::chrono::seconds>(since_epoch);
+		long long millis = std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch - seconds).count();
+		std::time_t t = static_cast<std::time_t>(seconds.count());
+
+		// Date and time up to the second last formatted by this thread.
+		thread_local std::time_t cached_time = -1;
+		thread_local char cached_date_time[time_template_width] = {};
+		thread_local size_t cached_date_time_length = 0;
+
+		// If the second has changed, format the date and time again based on the platform.
+		if (t != cached_time) {
+			std::tm now {};
+			#if defined(__unix__)
+				localtime_r(&t, &now);
+			#elif defined(_MSC_VER)
+				localtime_s(&now, &t);
+			#else
+				static std::mutex mtx;
+				std::lock_guard<std::mutex> lock(mtx);
+				now = *std::localtime(&t);
+			#endif
+
+			int date_time_bytes_written = std::snprintf(cached_date_time, 
+					time_template_width,
+					"%04d-%02d-%02d %02d:%02d:%02d",
+					now.tm_year + 1900,
+					now.tm_mon + 1,
+					now.tm_mday,
+					now.tm_hour,
+					now.tm_min,
+					now.tm_sec);
+			cached_date_time_length = std::min<size_t>(std::max(date_time_bytes_written, 0), time_template_width - 1);
+			cached_time = t;
+		}
+
+		// Copy the date and time, then append the milliseconds as ".0MMM" if they fit.
+		size_t length = cached_date_time_length;
+		std::memcpy(buffer, cached_date_time, length);
+		if (length + 5 < time_template_width) {
+			buffer[length++] = '.';
+			buffer[length++] = '0';
+			buffer[length++] = static_cast<char>('0' + millis / 100);
+			buffer[length++] = static_cast<char>('0' + millis / 10 % 10);
+			buffer[length++] = static_cast<char>('0' + millis % 10);
+		}
+		buffer[length] = '\0';
+		return length;
+	}
+
 	/**
 	 * 	@brief	Function generate_timestamp generates a string timestamp for messages based on the current time.
 	 * 	@return const std::string formatted timestamp string.
 	 */
-	const static std::string generate_timestamp() 
+	inline const std::string generate_timestamp() 
 	{
-		// Get the current number of milliseconds.
-		auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() % 1000;
-
-		// Get the current time based on the platform.
-		auto t = std::time(0);
-		std::tm now {};
-		#if defined(__unix__)
-			localtime_r(&t, &now);
-		#elif defined(_MSC_VER)
-			localtime_s(&now, &t);
-		#else
-			static std::mutex mtx;
-			std::lock_guard<std::mutex> lock(mtx);
-			now = *std::localtime(&t);
-		#endif			
-
-		// Format the time into a buffer.
 		char timestamp_buffer[time_template_width];
-		int timestamp_bytes_written = 0;
-		
-#ifdef _WIN32
-		// If on Windows, treat the milliseconds as a long long.
-		timestamp_bytes_written = std::snprintf(timestamp_buffer, 
-				time_template_width,
-				"%04d-%02d-%02d %02d:%02d:%02d.%04lld",
-				now.tm_year + 1900,
-				now.tm_mon + 1,
-				now.tm_mday,
-				now.tm_hour,
-				now.tm_min,
-				now.tm_sec,
-				millis);
-#else
-		// Otherwise, treat the milliseconds as a long.
-		timestamp_bytes_written = std::snprintf(timestamp_buffer, 
-				time_template_width,
-				"%04d-%02d-%02d %02d:%02d:%02d.%04ld",
-				now.tm_year + 1900,
-				now.tm_mon + 1,
-				now.tm_mday,
-				now.tm_hour,
-				now.tm_min,
-				now.tm_sec,
-				millis);
-#endif
-		if (timestamp_bytes_written > time_template_width) {
-			timestamp_buffer[time_template_width - 1] = '\0';
+		size_t timestamp_length = write_timestamp(timestamp_buffer);
+		return std::string(timestamp_buffer, timestamp_length);
+	}
+
+	/**
+	 * 	@class	format_buffer
+	 * 	@brief 	Class format_buffer is a growable buffer that messages are formatted into.
+	 * 	@details	The buffer keeps its storage when it is cleared, so once it has grown to fit the 
+	 * 				largest message, formatting into it doesn't allocate. Each thread has its own buffer, 
+	 * 				retrieved with get_thread_buffer.
+	 */
+	class format_buffer {
+	public:
+		/**
+		 * 	@brief	Constructor for the format_buffer class.
+		 * 	@param	resource 	std::pmr::memory_resource* resource to allocate the buffer's storage from.
+		 */
+		explicit format_buffer(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+			buffer(resource)
+		{}
+
+		/**
+		 * 	@brief	Method get_thread_buffer retrieves the calling thread's format buffer, emptied.
+		 * 	@return	format_buffer& the thread's format buffer.
+		 */
+		static format_buffer& get_thread_buffer() {
+			thread_local format_buffer buffer;
+			buffer.clear();
+			return buffer;
 		}
 
-		// Convert the buffer to a string.
-		return std::string(timestamp_buffer);
-	}
+		/**
+		 * 	@brief	Method clear empties the buffer, keeping its storage for reuse.
+		 */
+		void clear() {
+			buffer.clear();
+		}
+
+		/**
+		 * 	@brief	Method append adds text to the end of the buffer.
+		 * 	@param	text 	std::string_view text to add.
+		 */
+		void append(std::string_view text) {
+			buffer.append(text);
+		}
+
+		/**
+		 * 	@brief	Method pad adds a number of spaces to the end of the buffer.
+		 * 	@param	length 	size_t number of spaces to add.
+		 */
+		void pad(size_t length) {
+			buffer.append(length, ' ');
+		}
+
+		/**
+		 * 	@brief	Method view gets a view of the text in the buffer.
+		 * 	@return	std::string_view text in the buffer.
+		 */
+		std::string_view view() const {
+			return buffer;
+		}
+
+	private:
+		/// Storage for the text in the buffer.
+		std::pmr::string buffer;
+	};
+
+	/**
+	 * 	@class	bounded_buffer
+	 * 	@brief 	Class bounded_buffer formats a message into a fixed-size buffer provided by the caller.
+	 * 	@details	Text beyond the end of the buffer is dropped but still counted, so the length needed 
+	 * 				for the whole message is known once it has been formatted. The buffer never allocates 
+	 * 				or throws.
+	 */
+	class bounded_buffer {
+	public:
+		/**
+		 * 	@brief	Constructor for the bounded_buffer class.
+		 * 	@param	buffer 		char* buffer to format into, which may be nullptr if capacity is 0.
+		 * 	@param	capacity 	size_t size of the buffer in bytes.
+		 */
+		bounded_buffer(char* buffer, size_t capacity) noexcept :
+			buffer(buffer),
+			capacity(capacity),
+			needed(0)
+		{}
+
+		/**
+		 * 	@brief	Method append adds as much text as fits to the end of the buffer.
+		 * 	@param	text 	std::string_view text to add.
+		 */
+		void append(std::string_view text) noexcept {
+			if (needed < capacity) {
+				std::memcpy(buffer + needed, text.data(), std::min(text.length(), capacity - needed));
+			}
+			needed += text.length();
+		}
+
+		/**
+		 * 	@brief	Method pad adds as many of a number of spaces as fit to the end of the buffer.
+		 * 	@param	length 	size_t number of spaces to add.
+		 */
+		void pad(size_t length) noexcept {
+			if (needed < capacity) {
+				std::memset(buffer + needed, ' ', std::min(length, capacity - needed));
+			}
+			needed += length;
+		}
+
+		/**
+		 * 	@brief	Method length gets the length of all of the text added, including any that didn't fit.
+		 * 	@return	size_t length of the text in bytes.
+		 */
+		size_t length() const noexcept {
+			return needed;
+		}
+
+		/**
+		 * 	@brief	Method mark_truncation overwrites the end of the buffer with a marker if the text didn't fit.
+		 * 	@param	marker 	std::string_view marker to end truncated text with, which is left out if the buffer 
+		 * 					is smaller than it.
+		 * 	@return	size_t number of bytes written to the buffer.
+		 */
+		size_t mark_truncation(std::string_view marker) noexcept {
+			if (needed <= capacity) {
+				return needed;
+			}
+			if (marker.length() <= capacity) {
+				std::memcpy(buffer + capacity - marker.length(), marker.data(), marker.length());
+			}
+			return capacity;
+		}
+
+	private:
+		/// Buffer the text is written to.
+		char* buffer;
+		/// Size of the buffer in bytes.
+		size_t capacity;
+		/// Length of all of the text added.
+		size_t needed;
+	};
+
+	/**
+	 * 	@class	iterator_buffer
+	 * 	@brief 	Class iterator_buffer formats a message through an output iterator.
+	 * 	@tparam	OutputIterator 	type of output iterator of char to write to.
+	 */
+	template <typename OutputIterator>
+	class iterator_buffer {
+	public:
+		/**
+		 * 	@brief	Constructor for the iterator_buffer class.
+		 * 	@param	output 	OutputIterator iterator to write the text to.
+		 */
+		explicit iterator_buffer(OutputIterator output) :
+			output(output)
+		{}
+
+		/**
+		 * 	@brief	Method append writes text to the iterator.
+		 * 	@param	text 	std::string_view text to write.
+		 */
+		void append(std::string_view text) {
+			output = std::copy(text.begin(), text.end(), output);
+		}
+
+		/**
+		 * 	@brief	Method pad writes a number of spaces to the iterator.
+		 * 	@param	length 	size_t number of spaces to write.
+		 */
+		void pad(size_t length) {
+			output = std::fill_n(output, length, ' ');
+		}
+
+		/**
+		 * 	@brief	Method get_iterator gets the iterator past the last text written.
+		 * 	@return	OutputIterator iterator past the end of the text.
+		 */
+		OutputIterator get_iterator() const {
+			return output;
+		}
+
+	private:
+		/// Iterator the text is written to.
+		OutputIterator output;
+	};
+
+	/**
+	 * 	@class	indented_output
+	 * 	@brief 	Class indented_output indents every line written to another output.
+	 * 	@tparam	Output 	type of output to write to, with append(std::string_view) and pad(size_t) methods.
+	 */
+	template <typename Output>
+	class indented_output {
+	public:
+		/**
+		 * 	@brief	Constructor for the indented_output class.
+		 * 	@param	output 	Output& output to write the indented text to.
+		 * 	@param	indent 	size_t number of spaces to start each line with.
+		 */
+		indented_output(Output& output, size_t indent) :
+			output(output),
+			indent(indent),
+			line_start(true)
+		{}
+
+		/**
+		 * 	@brief	Method append writes text to the output, indenting each line it starts.
+		 * 	@param	text 	std::string_view text to write.
+		 */
+		void append(std::string_view text) {
+			while (!text.empty()) {
+				start_line();
+				size_t line_end = text.find('\n');
+				if (line_end == std::string_view::npos) {
+					output.append(text);
+					return;
+				}
+				output.append(text.substr(0, line_end + 1));
+				text.remove_prefix(line_end + 1);
+				line_start = true;
+			}
+		}
+
+		/**
+		 * 	@brief	Method pad writes a number of spaces to the output, indenting the line if it starts it.
+		 * 	@param	length 	size_t number of spaces to write.
+		 */
+		void pad(size_t length) {
+			if (length > 0) {
+				start_line();
+				output.pad(length);
+			}
+		}
+
+	private:
+		/// Output the indented text is written to.
+		Output& output;
+		/// Number of spaces each line starts with.
+		size_t indent;
+		/// Flag for if the next text starts a line.
+		bool line_start;
+
+		/**
+		 * 	@brief	Method start_line indents the line if the next text starts it.
+		 */
+		void start_line() {
+			if (line_start) {
+				output.pad(indent);
+				line_start = false;
+			}
+		}
+	};
 }
 
 
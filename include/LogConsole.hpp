@@ -15,102 +15,544 @@
 #define NOMINMAX
 #endif
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <deque>
 #include <iostream>
-#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <mutex>
-#include <queue>
 #include <string>
-#include <sstream>
+#include <string_view>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 // Platform Dependant System Libraries
 #ifdef _WIN32
+#include <io.h>
 #include <windows.h>
 #else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 #endif
 
 // Log Base Header
 #include "LogBase.hpp"
+// Log Exception Header
+#include "LogException.hpp"
+// Log Stack Trace Header
+#include "LogStackTrace.hpp"
 
 namespace logging {
+#ifdef _WIN32
 	/**
-	 * 	@anchor		console
-	 * 	@class 		console
-	 * 	@brief 		Class console is used to print formatted messages to the console.
-	 * 	@details	The class tracks the messages that have been sent previously along 
-	 * 				with the current size of the console, to print messages into columns
-	 * 				along with splitting multi-line messages accordingly. The output 
-	 * 				follows the format:
-	 * 				| [SEVERITY] (NAME) MESSAGE LINE 1				|
-	 * 				|					LONGER MESSAGE LINE 2 		|
-	 * 				|					EVEN LONGER MESSAGE LINE 2	|
-	 * 				| [SEVERITY] (NAME) MESSAGE LINE 1				|
+	 * 	@brief	Struct iovec describes a block of output for a gathered write, as defined by POSIX.
+	 */
+	struct iovec {
+		/// Start of the block.
+		void* iov_base;
+		/// Length of the block in bytes.
+		size_t iov_len;
+	};
+#endif
+
+	/**
+	 * 	@brief	Enum fork_policy is what a child process does with the messages queued when it was forked.
+	 */
+	enum class fork_policy {
+		/// The child drops the queued messages, which are printed by the parent.
+		discard,
+		/// The child prints the queued messages too, so they are printed by both processes.
+		preserve
+	};
+
+	/**
+	 * 	@brief	Struct thread_config holds the settings the console's child thread applies to itself before it 
+	 * 			prints anything, e.g. to keep it off cores reserved for latency critical threads.
+	 * 	@note	The settings are applied on Linux and ignored on other platforms.
+	 */
+	struct thread_config {
+		/// CPUs the thread may run on, or empty to inherit the affinity of the thread that starts it.
+		std::vector<unsigned int> cpus{};
+		/// Scheduling policy of the thread, e.g. SCHED_BATCH, SCHED_IDLE or SCHED_FIFO, or -1 to inherit it.
+		int policy = -1;
+		/// Static priority of the thread for the SCHED_FIFO and SCHED_RR policies.
+		int priority = 0;
+		/// Nice value of the thread for the other policies, or 0 to inherit it.
+		int nice = 0;
+		/// Name of the thread shown by tools like top, at most 15 characters, or empty to inherit it.
+		std::string name = "logging";
+	};
+
+	/**
+	 * 	@brief	Struct config holds the settings applied to the console by logging::init, or to an independent 
+	 * 			console when it is constructed, before its child thread starts.
+	 */
+	struct config {
+		/// Number of messages to reserve space for in the print queue, so it doesn't grow in steady state.
+		size_t queue_capacity = 0;
+		/// Memory resource to allocate from, or nullptr to keep the resource the console already uses.
+		std::pmr::memory_resource* memory_resource = nullptr;
+		/// File descriptor of the sink the console writes to, which is stdout by default (ignored on Windows).
+		int output_descriptor = 1;
+		/// What a child process does with the messages queued when it was forked.
+		fork_policy on_fork = fork_policy::discard;
+		/// File descriptor a child process writes to after it is forked, or -1 to keep the same sink.
+		int child_output_descriptor = -1;
+		/// Settings of the child thread that prints queued messages.
+		thread_config print_thread{};
+		/// Flag to print queued messages from an external event loop with console::drain, instead of a child thread.
+		bool external_drain = false;
+		/// Expected maximum length of names, which sets the width of the name column, or 0 to keep the width.
+		unsigned int max_name_length = 0;
+		/// Flag to queue messages in a shard of the print queue for each NUMA node, allocated on that node, so 
+		/// producers don't write to another socket's memory (Linux only). Messages are only ordered within a 
+		/// node, so a producer that migrates to another node may have its later messages printed first.
+		bool numa_shards = false;
+		/// Bytes of 2 MiB huge pages to map and prefault for the console's records, or 0 to allocate them from 
+		/// the memory resource, which takes precedence if one is given without prefault_memory.
+		size_t huge_page_bytes = 0;
+		/// Flag to allocate and touch the queue, chunk and output storage up front, so the first message doesn't 
+		/// take page faults, and to warn if that storage grows once the console is running. Records are then 
+		/// allocated from a prefaulted region in front of the memory resource, of huge_page_bytes or else sized 
+		/// for the queue.
+		bool prefault_memory = false;
+		/// Flag to lock the prefaulted storage and huge pages into memory with mlock, so they are never paged out.
+		bool lock_memory = false;
+	};
+
+	/**
+	 * 	@brief	Namespace overflow holds the policies for what basic_console does with a message when its print
+	 * 			queue is full.
+	 */
+	namespace overflow {
+		/**
+		 * 	@brief	Struct grow makes room for every message by growing the print queue, which is the default.
+		 */
+		struct grow {};
+
+		/**
+		 * 	@brief	Struct block makes the producer wait for the print thread to take the queue, so no message is
+		 * 			lost.
+		 * 	@note	The producer can't wait for itself, so this must not be used by the thread that calls drain.
+		 */
+		struct block {};
+
+		/**
+		 * 	@brief	Struct drop drops messages that don't fit in the print queue and counts them, so producers
+		 * 			never wait. The count is printed with the next messages.
+		 */
+		struct drop {};
+	}
+
+	/**
+	 * 	@brief	Namespace clocks holds the clocks basic_console can timestamp messages with. Each has a static
+	 * 			now method returning a std::chrono::system_clock::time_point.
+	 */
+	namespace clocks {
+		/**
+		 * 	@brief	Struct system timestamps messages with std::chrono::system_clock, which is the default.
+		 */
+		struct system {
+			static std::chrono::system_clock::time_point now() noexcept {
+				return std::chrono::system_clock::now();
+			}
+		};
+
+		/**
+		 * 	@brief	Struct coarse timestamps messages with the coarse real-time clock on Linux, which is cheaper to
+		 * 			read and only updated every few milliseconds.
+		 * 	@note	Other platforms use std::chrono::system_clock.
+		 */
+		struct coarse {
+			static std::chrono::system_clock::time_point now() noexcept {
+#ifdef CLOCK_REALTIME_COARSE
+				timespec time{};
+				clock_gettime(CLOCK_REALTIME_COARSE, &time);
+				return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+					std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec)));
+#else
+				return std::chrono::system_clock::now();
+#endif
+			}
+		};
+	}
+
+	/**
+	 * 	@class 		huge_page_resource
+	 * 	@brief 		Class huge_page_resource is a memory resource that allocates from a region of 2 MiB huge pages, 
+	 * 				which is mapped and prefaulted when it is constructed.
+	 * 	@details	Producers writing records to a large queue then take neither page faults nor as many TLB 
+	 * 				misses, even on their first pass over it. The region is mapped with MAP_HUGETLB if huge pages 
+	 * 				are reserved, then with madvise(MADV_HUGEPAGE) for transparent huge pages, then with normal 
+	 * 				pages, which are still prefaulted. Small freed blocks are pooled by size for reuse, and larger 
+	 * 				ones are given back to the region, which reuses them first fit and merges neighbours. Once 
+	 * 				the region is used up blocks are allocated from the upstream resource. An example usage is 
+	 * 				included below.
+	 * 	@code {.cpp}
+	 * 	logging::huge_page_resource records(256 * 1024 * 1024);
+	 * 	logging::console::set_memory_resource(&records);
+	 * 	@endcode
+	 * 	@note		Only Linux maps huge pages. Other POSIX platforms map normal pages, and Windows allocates 
+	 * 				everything from the upstream resource.
 	 */
-	class console {
+	class huge_page_resource : public std::pmr::memory_resource {
 	public:
-		/*************************************************************************************************/
-		/* Non-Static Methods																			 */
-		/*************************************************************************************************/
+		/// Size of a huge page, which the region is rounded up to and aligned to.
+		const static inline size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+		/// Size of a normal page, which prefaulting writes to once each.
+		const static inline size_t NORMAL_PAGE_SIZE = 4096;
+
 		/**
-		 * @brief 	Method get_instance retrieves the singleton instance of the console class.
-		 * @return 	console& singleton instance of the console class.
+		 * 	@brief	Constructor for the huge_page_resource class, which maps and prefaults the region.
+		 * 	@param	size 		size_t bytes to map, rounded up to a whole number of huge pages.
+		 * 	@param	upstream 	std::pmr::memory_resource* resource to allocate from once the region is used up, or 
+		 * 						if it can't be mapped.
 		 */
-		static console& get_instance() {
-			static console instance;
-			return instance;
-		}
+		explicit huge_page_resource(size_t size, std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) :
+			region(map_region(size), upstream),
+			pool(&region)
+		{}
 
 		/// Deleted cloning constructor.
-		console(console &other) = delete;
+		huge_page_resource(const huge_page_resource&) = delete;
 		/// Deleted assignment operator.
-		void operator=(const console &) = delete;
+		void operator=(const huge_page_resource&) = delete;
 
 		/**
-		 * 	@brief 		Method print_parallel sends the provided message to a child thread to
-		 * 				print as a formatted message to the console.
-		 * 	@details	The class tracks the messages that have been sent previously along 
-		 * 				with the current size of the console, to print messages into columns
-		 * 				along with splitting multi-line messages accordingly. The output 
-		 * 				follows the format:
-		 * 				| [SEVERITY] (NAME) MESSAGE LINE 1				|
-		 * 				|					LONGER MESSAGE LINE 2 		|
-		 * 				|					EVEN LONGER MESSAGE LINE 2	|
-		 * 				| [SEVERITY] (NAME) MESSAGE LINE 1				|
-		 * 	@param 		message 	string message to print to the console.
-		 * 	@param 		name 		string name of the component printing the message.
-		 * 	@param 		severity	logging::severity of the message.
-		 * 	@note		messages can contain newline characters ('\n') to print the message 
-		 * 				over separate lines.
-		 * 	@note		This method has significantly less overhead than the print method (by 
-		 * 				around 30x), and thus should be preferred for real-time use. The method 
-		 * 				works by adding the message to a queue where a child thread can service 
-		 * 				each print, thus blocking for a shorter period. An example usage is 
-		 * 				included below.
-		 * 	@code {.cpp}
-		 * 	logging::console::get_instance().print_parallel(
-		 * 		"Hello World!", 
-		 * 		"Example", 
-		 * 		logging::severity::info
-		 * 	)
-		 * 	@endcode
-		 * 
+		 * 	@brief	Method get_size gets the size of the mapped region.
+		 * 	@return	size_t bytes mapped, which is 0 if the region couldn't be mapped.
 		 */
-		void print_parallel(
-			const std::string message, 
-			const std::string name,
-			const severity severity = severity::error) 
-		{
-			std::unique_lock lock(print_queue_mutex);
-			print_queue.push(std::make_tuple(message, name, severity));
-			print_queue_empty.store(print_queue.empty());
-			print_queue_condition_variable.notify_one();		
+		size_t get_size() const {
+			return region.mapping.size;
+		}
+
+		/**
+		 * 	@brief	Method is_huge checks if the region is backed by huge pages.
+		 * 	@return	bool true if the region was mapped with MAP_HUGETLB or advised to use transparent huge pages.
+		 */
+		bool is_huge() const {
+			return region.mapping.huge;
+		}
+
+		/**
+		 * 	@brief	Method contains checks if a block was allocated from the region.
+		 * 	@param	pointer 	const void* start of the block.
+		 * 	@return	bool true if the block is in the region, or false if it was allocated upstream.
+		 */
+		bool contains(const void* pointer) const {
+			return region.contains(pointer);
+		}
+
+		/**
+		 * 	@brief	Method get_overflow_count gets the number of blocks allocated upstream because the region was 
+		 * 			used up.
+		 * 	@return	uint64_t number of blocks allocated upstream.
+		 */
+		uint64_t get_overflow_count() const {
+			return region.overflows.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * 	@brief	Method lock locks the region into memory, so it is never paged out.
+		 * 	@return	int 0 if the region was locked, or else the error number, e.g. ENOMEM if it is over the 
+		 * 			RLIMIT_MEMLOCK limit.
+		 */
+		int lock() {
+#ifdef _WIN32
+			return 0;
+#else
+			if (region.mapping.start == nullptr || mlock(region.mapping.start, region.mapping.size) == 0) {
+				return 0;
+			}
+			return errno;
+#endif
+		}
+
+	protected:
+		/// Method do_allocate allocates a block from the pools of freed blocks, or else from the region.
+		void* do_allocate(size_t bytes, size_t alignment) override {
+			return pool.allocate(bytes, alignment);
+		}
+
+		/// Method do_deallocate returns a block to the pools for reuse.
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+			pool.deallocate(pointer, bytes, alignment);
+		}
+
+		/// Method do_is_equal checks if another resource is this resource.
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+
+	private:
+		/**
+		 * 	@brief	Struct mapped_region describes the region mapped for the resource.
+		 */
+		struct mapped_region {
+			/// Start of the region, or nullptr if it couldn't be mapped.
+			char* start = nullptr;
+			/// Bytes in the region.
+			size_t size = 0;
+			/// Flag for if the region is backed by huge pages.
+			bool huge = false;
+		};
+
+		/**
+		 * 	@class	region_resource
+		 * 	@brief	Class region_resource hands out the mapped region in order, then allocates from the upstream 
+		 * 			resource once it is used up.
+		 * 	@details	Blocks given back to the region are kept in a list in address order, merged with their 
+		 * 				neighbours, and reused first fit before more of the region is handed out. A block given 
+		 * 				back from the end of what has been handed out is returned to the rest of the region.
+		 */
+		class region_resource : public std::pmr::memory_resource {
+		public:
+			/**
+			 * 	@brief	Constructor for the region_resource class.
+			 * 	@param	mapping 	mapped_region to allocate from, which is unmapped when the resource is destroyed.
+			 * 	@param	upstream 	std::pmr::memory_resource* resource to allocate from once the region is used up.
+			 */
+			region_resource(mapped_region mapping, std::pmr::memory_resource* upstream) :
+				mapping(mapping),
+				overflows(0),
+				used(0),
+				upstream(upstream)
+			{}
+
+			/// Destructor for the region_resource class, which unmaps the region.
+			~region_resource() override {
+#ifndef _WIN32
+				if (mapping.start != nullptr) {
+					munmap(mapping.start, mapping.size);
+				}
+#endif
+			}
+
+			/// Region the resource allocates from.
+			mapped_region mapping;
+			/// Number of blocks allocated upstream because they didn't fit in the region.
+			threading::atomic<uint64_t> overflows;
+
+			/**
+			 * 	@brief	Method contains checks if a block is in the region.
+			 * 	@param	pointer 	const void* start of the block.
+			 * 	@return	bool true if the block is in the region.
+			 */
+			bool contains(const void* pointer) const {
+				const char* block = static_cast<const char*>(pointer);
+				return mapping.start != nullptr && block >= mapping.start && block < mapping.start + mapping.size;
+			}
+
+		protected:
+			/// Method do_allocate reuses a block given back to the region, or takes the next block of the region, 
+			/// or allocates one upstream if neither fits.
+			void* do_allocate(size_t bytes, size_t alignment) override {
+				size_t size = round_size(bytes);
+				alignment = std::max(alignment, GRANULE);
+				{
+					std::scoped_lock<threading::mutex> lock(mutex);
+					for (free_block** link = &free_blocks; *link != nullptr; link = &(*link)->next) {
+						free_block* block = *link;
+						if (block->size < size || reinterpret_cast<uintptr_t>(block) % alignment != 0) {
+							continue;
+						}
+						// Split off the rest of the block, which stays in place in the list.
+						if (block->size > size) {
+							free_block* rest = reinterpret_cast<free_block*>(reinterpret_cast<char*>(block) + size);
+							rest->size = block->size - size;
+							rest->next = block->next;
+							*link = rest;
+						}
+						else {
+							*link = block->next;
+						}
+						return block;
+					}
+					size_t offset = (used + alignment - 1) & ~(alignment - 1);
+					if (mapping.start != nullptr && offset <= mapping.size && size <= mapping.size - offset) {
+						used = offset + size;
+						return mapping.start + offset;
+					}
+				}
+				overflows.fetch_add(1, std::memory_order_relaxed);
+				return upstream->allocate(bytes, alignment);
+			}
+
+			/// Method do_deallocate gives a block back to the region, or frees it upstream if it was allocated there.
+			void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+				if (!contains(pointer)) {
+					upstream->deallocate(pointer, bytes, std::max(alignment, GRANULE));
+					return;
+				}
+				char* start = static_cast<char*>(pointer);
+				size_t size = round_size(bytes);
+				std::scoped_lock<threading::mutex> lock(mutex);
+
+				// Find the blocks either side of the one given back, merging it with them if they touch it.
+				free_block* previous = nullptr;
+				free_block** link = &free_blocks;
+				while (*link != nullptr && reinterpret_cast<char*>(*link) < start) {
+					previous = *link;
+					link = &(*link)->next;
+				}
+				free_block* next = *link;
+				free_block* block = reinterpret_cast<free_block*>(start);
+				block->size = size;
+				block->next = next;
+				if (next != nullptr && start + size == reinterpret_cast<char*>(next)) {
+					block->size += next->size;
+					block->next = next->next;
+				}
+				if (previous != nullptr && reinterpret_cast<char*>(previous) + previous->size == start) {
+					previous->size += block->size;
+					previous->next = block->next;
+					block = previous;
+				}
+				else {
+					*link = block;
+				}
+
+				// Return a block at the end of what has been handed out to the rest of the region.
+				if (reinterpret_cast<char*>(block) + block->size == mapping.start + used && block->next == nullptr) {
+					used = reinterpret_cast<char*>(block) - mapping.start;
+					free_block** last = &free_blocks;
+					while (*last != block) {
+						last = &(*last)->next;
+					}
+					*last = nullptr;
+				}
+			}
+
+			/// Method do_is_equal checks if another resource is this resource.
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+				return this == &other;
+			}
+
+		private:
+			/**
+			 * 	@brief	Struct free_block is the header written at the start of a block given back to the region.
+			 */
+			struct free_block {
+				/// Bytes in the block, including the header.
+				size_t size;
+				/// Next block given back, at a higher address, or nullptr if this is the last.
+				free_block* next;
+			};
+
+			/// Unit the sizes of blocks from the region are rounded up to, which holds a free block header.
+			const static inline size_t GRANULE = std::max(alignof(std::max_align_t), sizeof(free_block));
+
+			/// Mutex to protect the bytes used and the blocks given back.
+			threading::mutex mutex;
+			/// Bytes of the region handed out so far.
+			size_t used;
+			/// Blocks given back to the region in address order, or nullptr if there are none.
+			free_block* free_blocks = nullptr;
+
+			/**
+			 * 	@brief	Static method round_size rounds the size of a block up to a whole number of granules.
+			 * 	@param	bytes 	size_t bytes requested.
+			 * 	@return	size_t bytes the block takes in the region.
+			 */
+			static size_t round_size(size_t bytes) {
+				return (std::max<size_t>(bytes, 1) + GRANULE - 1) / GRANULE * GRANULE;
+			}
+			/// Resource to allocate from once the region is used up.
+			std::pmr::memory_resource* upstream;
+		};
+
+		/// Type of the pools of freed blocks, which only lock in multi-threaded builds.
+		using pool_resource = std::conditional_t<threading::SINGLE_THREADED, 
+			std::pmr::unsynchronized_pool_resource, std::pmr::synchronized_pool_resource>;
+
+		/// Region the pools take blocks from, which must outlive them.
+		region_resource region;
+		/// Pools of freed blocks, sorted by size.
+		pool_resource pool;
+
+		/**
+		 * 	@brief	Static method map_region maps a region of huge pages, falling back to normal pages, and writes 
+		 * 			to each page so it is faulted in now rather than on first use.
+		 * 	@param	size 	size_t bytes to map, rounded up to a whole number of huge pages.
+		 * 	@return	mapped_region region mapped, which is empty if it couldn't be mapped.
+		 */
+		static mapped_region map_region([[maybe_unused]] size_t size) {
+			mapped_region mapping;
+#ifndef _WIN32
+			if (size == 0) {
+				return mapping;
+			}
+			size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+#ifdef MAP_HUGETLB
+			// Reserved huge pages are faulted in by MAP_POPULATE.
+			void* start = mmap(nullptr, size, PROT_READ | PROT_WRITE, 
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+			if (start != MAP_FAILED) {
+				return mapped_region{static_cast<char*>(start), size, true};
+			}
+#endif
+			// Otherwise map an extra huge page so the region can be aligned to one, then trim the ends.
+			void* unaligned = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, 
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (unaligned == MAP_FAILED) {
+				return mapping;
+			}
+			char* first = static_cast<char*>(unaligned);
+			char* aligned = reinterpret_cast<char*>(
+				(reinterpret_cast<uintptr_t>(first) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+			if (aligned > first) {
+				munmap(first, aligned - first);
+			}
+			if (aligned + size < first + size + HUGE_PAGE_SIZE) {
+				munmap(aligned + size, first + size + HUGE_PAGE_SIZE - (aligned + size));
+			}
+			mapping = mapped_region{aligned, size, false};
+#ifdef MADV_HUGEPAGE
+			mapping.huge = madvise(aligned, size, MADV_HUGEPAGE) == 0;
+#endif
+			for (size_t offset = 0; offset < size; offset += NORMAL_PAGE_SIZE) {
+				static_cast<volatile char*>(aligned)[offset] = 0;
+			}
+#endif
+			return mapping;
 		}
+	};
 
+	/**
+	 * 	@class 		console_base
+	 * 	@brief 		Class console_base holds what every console shares, whatever its policies: the sink for stdout,
+	 * 				the status line, the console width and the list of consoles the fork handlers quiesce.
+	 * 	@details	It also lays messages out, which print does synchronously and each basic_console does in its
+	 * 				print thread. Its static methods are called through any console, e.g. logging::console::print.
+	 */
+	class console_base {
+	public:
 		/*************************************************************************************************/
 		/* Static Methods																				 */
 		/*************************************************************************************************/
@@ -131,179 +573,3259 @@ namespace logging {
 		 * 				over separate lines.
 		 */
 		const static void print(
-			const std::string message, 
-			const std::string name,
+			std::string_view message, 
+			std::string_view name,
 			const severity severity = severity::error) 
 		{
-			// Update the maximum name width.
-			max_name_width = std::max(max_name_width, (unsigned int)name.length());
-
-			// Generate the timestamp for the message.
-			std::string timestamp = generate_timestamp();
-
-			// Split the message into a queue of lines.
-			std::deque<std::string> message_lines = logging::split_string(message, "\n");
-
-			// Create a string stream to write the formatted output string to.
-			std::stringstream ss;
-
-			// Print the first line of the output in the format:
-			// [TIME] [SEVERITY] (NAME) MESSAGE LINE 1
-			ss 	<< std::left 
-				<< "[" << std::setw(time_template_width) << timestamp + "]" 
-				<< "[" << std::setw(Severity::get_max_severity_length() + 2) << std::string(Severity(severity)) + "]" 
-				<< "(" << std::setw(max_name_width + 2) << std::string(name) + ")";
-
-			// Get the first line of the message (there is guaranteed to be 1).
-			std::string line = message_lines.front();
-			message_lines.pop_front();
-
-			// Get the width of the preamble printed before the first line.
-			size_t preamble_width = ss.str().length();
-
-			// Write the first line of the message to the string stream.
-			ss << line + "\n";
-
-			// While there are remaining lines in the message,
-			while (!message_lines.empty()) {
-				// Get the line.
-				line = message_lines.front();
-				message_lines.pop_front();
-
-				// Write the line to the output in line with the message lines above it.
-				ss << std::setw(preamble_width) << " " << line + "\n";
+			// Lay the message out in this thread's output buffer and print it.
+			thread_local gather_buffer output;
+			thread_local line_view line;
+			output.clear();
+			if (stack_trace::should_capture(severity)) {
+				// Follow the message with a stack trace, naming its frames in this thread.
+				std::array<void*, stack_trace::MAX_FRAMES> frames;
+				size_t frame_count = stack_trace::capture(frames.data(), frames.size());
+				thread_local std::vector<std::string_view> segments;
+				segments.assign(1, message);
+				for (size_t i = 0; i < frame_count; i++) {
+					segments.emplace_back(stack_trace::FRAME_PREFIX);
+					segments.emplace_back(stack_trace::get_symbol(frames[i]));
+				}
+				layout(segments.data(), segments.size(), name, severity, std::chrono::system_clock::now(), output, line, max_name_width, standard_output.is_colour(), load_console_width());
 			}
-
-			{
-				// Lock the standard output mutex.
-				std::scoped_lock<std::mutex> std_out_lock(std_out_mutex);
-
-				// Print the fully formatted string.
-				std::cout << ss.str();
+			else {
+				layout(message, name, severity, std::chrono::system_clock::now(), output, line, max_name_width, standard_output.is_colour(), load_console_width());
 			}
+			// In single threaded builds nothing would flush the output later, so it is written straight away.
+			standard_output.write(output, threading::SINGLE_THREADED);
+		}
+
+		/**
+		 * 	@brief 	Static method flush writes any output that has been buffered because stdout is not a terminal.
+		 * 	@note	Buffered output is flushed automatically when the buffer fills, or within OUTPUT_FLUSH_INTERVAL 
+		 * 			of it being printed, so this is only needed before handing stdout to something else.
+		 */
+		static void flush() {
+			standard_output.flush();
 		}
 
 		/**
 		 * 	@brief Method set_max_name_length sets the expected maximum length of names printed to the console, so 
 		 * 			console output can have consistent columns.
 		 * 	@param length unsigned int maximum length of names.
+		 * 	@note	This sets the name column of print and the console singleton. Independent consoles set theirs 
+		 * 			with config::max_name_length.
 		 */
 		static void set_max_name_length(unsigned int length) {
 			max_name_width = length;
 		}
 
-	protected:
-		/*************************************************************************************************/
-		/* Static Members																				 */
-		/*************************************************************************************************/
-		/// Number of milliseconds to timeout after when waiting on condition variables.
-		const static inline std::chrono::milliseconds WAIT_TIMEOUT_MS = std::chrono::milliseconds(100);;
-		/// Protected member to lock printing access between threads.
-		static std::mutex std_out_mutex;
-		/// Maximum severity width in characters seen so far.
-		static unsigned int max_severity_width;
-		/// Maximum name width in characters seen so far.
-		static unsigned int max_name_width;	
+		/**
+		 * 	@brief 	Method set_console_width overrides the cached width of the console that message lines are 
+		 * 			wrapped at.
+		 * 	@param 	width unsigned int width of the console in characters, or 0 to disable wrapping.
+		 * 	@note	The cached width is refreshed from the terminal whenever it is resized (SIGWINCH), so this 
+		 * 			is mostly useful when stdout is not a terminal.
+		 */
+		static void set_console_width(unsigned int width) {
+			// Initialise the width first, so it doesn't replace the override later.
+			load_console_width();
+			console_width.store(width, std::memory_order_relaxed);
+		}
 
-		/*************************************************************************************************/
-		/* Non-Static Members																			 */
-		/*************************************************************************************************/
-		/// Flag to interrupt the singleton child threads. 
-		std::atomic_bool interrupt_flag;
-		/// Queue of messages to be serviced by the printing child thread.
-		std::queue<std::tuple<std::string, std::string, logging::severity>> print_queue;
-		/// Flag for if the print queue is empty.
-		std::atomic_bool print_queue_empty;
-		/// Printing child thread which will service the print queue.
-		std::thread print_thread;
-		/// Mutex to protect access to the print queue.
-		std::mutex print_queue_mutex;
-		/// Condition variable to indicate to the print thread when there are messages to print.
-		std::condition_variable print_queue_condition_variable;
+		/**
+		 * 	@brief 	Method set_colour_output sets whether the severity column is coloured with ANSI escape codes.
+		 * 	@param 	enabled bool true to colour warnings yellow and errors red, false for plain output.
+		 * 	@note	Colour is enabled by default when stdout is a terminal and the NO_COLOR environment variable 
+		 * 			is not set.
+		 */
+		static void set_colour_output(bool enabled) {
+			standard_output.set_colour(enabled);
+		}
 
-		/*************************************************************************************************/
-		/* Non-Static Methods																			 */
-		/*************************************************************************************************/
 		/**
-		 * @brief Protected constructor for the console class which launches the child threads.
+		 * 	@brief 		Method set_memory_resource sets the memory resource the console allocates queued 
+		 * 				messages, message chunks and formatted output from.
+		 * 	@details	This lets logging share a subsystem's pool or monotonic resource rather than 
+		 * 				contending on the global heap. The resource is used by the console singleton 
+		 * 				when it is created, so this must be called before the first call to get_instance.
+		 * 	@param 		resource 	std::pmr::memory_resource* resource to allocate from, which must outlive 
+		 * 							the console, or nullptr for the default resource.
+		 * 	@note		The resource is shared by the producer threads and the child thread, so it must 
+		 * 				be thread safe, e.g. a std::pmr::synchronized_pool_resource.
 		 */
-		console() :
-			interrupt_flag(false),
-			print_queue{},
-			print_queue_empty(false),
-			print_thread(&console::empty_print_queue, this)
-		{}
+		static void set_memory_resource(std::pmr::memory_resource* resource) {
+			initial_memory_resource.store(resource);
+		}
 
 		/**
-		 * @brief Destructor for the console class which interrupts the child threads.
+		 * 	@brief 	Method set_progress updates the progress shown on the status line.
+		 * 	@param 	progress uint64_t amount of progress made out of the total passed to set_status.
+		 * 	@note	This only stores the progress, so it is cheap enough to call from hot loops. The status 
+		 * 			line is redrawn by the console thread.
 		 */
-		~console()
-		{
-			interrupt_flag.store(true);
-			if (print_thread.joinable()) {
-				print_thread.join();
+		static void set_progress(uint64_t progress) {
+			status_progress.store(progress, std::memory_order_relaxed);
+		}
+
+		/**
+		 * 	@brief 	Method clear_status removes the status line from the console.
+		 */
+		static void clear_status() {
+			status_active.store(false);
+			std::scoped_lock<threading::mutex> std_out_lock(standard_output.mutex);
+			if (!status_line.empty()) {
+				standard_output.write_direct(ERASE_LINE);
+				status_line.clear();
 			}
 		}
 
 		/**
-		 *	@brief	Method empty_print_queue runs in it's own thread, where it waits on the print queue 
-		 *			condition variable for messages then prints them to the console.
+		 * 	@brief 	Method set_status_refresh_rate sets the maximum number of times per second that the status line 
+		 * 			is redrawn.
+		 * 	@param 	rate unsigned int maximum number of redraws per second.
 		 */
-		void empty_print_queue() {
-			// Create variables to store attributes of each message.
-			std::string message, name = "";
-			logging::severity severity = logging::severity::error;
+		static void set_status_refresh_rate(unsigned int rate) {
+			status_refresh_rate.store(std::max(rate, 1u), std::memory_order_relaxed);
+		}
 
-			// While the thread has not been interrupted,
-			while(!interrupt_flag.load()) {
-				// If the print queue is empty,
-				if (print_queue_empty.load()) {
-					// Wait on the print queue empty condition variable for a fixed duration,
-					std::unique_lock<std::mutex> print_queue_lock(print_queue_mutex);
-					while (print_queue_condition_variable.wait_for(print_queue_lock, WAIT_TIMEOUT_MS) == std::cv_status::timeout && !interrupt_flag.load()) {}
-					// If waiting was interrupted by the interrupt flag, exit.
-					if (interrupt_flag.load()) {return;}
-					print_queue_lock.unlock();
+	protected:
+		/**
+		 * 	@class	gather_buffer
+		 * 	@brief	Class gather_buffer collects formatted output as a list of blocks for a single gathered write.
+		 * 	@details	Short pieces of output, like the preamble, padding and short lines, are copied into a 
+		 * 				scratch buffer where neighbouring pieces merge into one block. Long message lines are 
+		 * 				referenced where they already are, so they are never copied in user space.
+		 * 	@note	Referenced lines must stay alive until the output has been written.
+		 */
+		class gather_buffer {
+		public:
+			/**
+			 * 	@brief	Constructor for the gather_buffer class.
+			 * 	@param	resource 	std::pmr::memory_resource* resource to allocate the buffer's storage from.
+			 */
+			explicit gather_buffer(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+				scratch(resource),
+				vectors(resource)
+			{}
+
+			/**
+			 * 	@brief	Method prefault allocates and touches storage for the buffer, so laying out output doesn't 
+			 * 			take page faults.
+			 * 	@param	bytes 	size_t number of bytes of output to make room for.
+			 * 	@param	blocks 	size_t number of blocks of output to make room for.
+			 */
+			void prefault(size_t bytes, size_t blocks) {
+				scratch.resize(std::max(bytes, scratch.size()));
+				vectors.resize(std::max(blocks, vectors.size()));
+				clear();
+			}
+
+			/**
+			 * 	@brief	Method capacity gets the size of the storage the buffer has allocated.
+			 * 	@return	size_t bytes allocated for copied output and blocks.
+			 */
+			size_t capacity() const {
+				return scratch.capacity() + vectors.capacity() * sizeof(iovec);
+			}
+
+			/**
+			 * 	@brief	Method clear empties the buffer, keeping its storage for reuse.
+			 */
+			void clear() {
+				scratch.clear();
+				vectors.clear();
+				output_length = 0;
+			}
+
+			/**
+			 * 	@brief	Method append adds a piece of output, copying it if it is short or referencing it if it is long.
+			 * 	@param	data 	std::string_view output to add.
+			 */
+			void append(std::string_view data) {
+				if (data.length() >= REFERENCE_LENGTH) {
+					add(data.data(), data.length());
 				}
-				// Once the print queue is not empty,
 				else {
-					{
-						// Wait for the print queue to have messages in it, or until 100ms have elapsed.
-						std::scoped_lock<std::mutex> print_queue_lock(print_queue_mutex);
-						// Retrieve the elements of the message from the queue.
-						std::tie(message, name, severity) = print_queue.front();
-						print_queue.pop();
-						print_queue_empty.store(print_queue.empty());
+					scratch.append(data);
+					add(nullptr, data.length());
+				}
+			}
+
+			/**
+			 * 	@brief	Method pad adds a number of spaces to the output.
+			 * 	@param	length 	size_t number of spaces to add.
+			 */
+			void pad(size_t length) {
+				scratch.append(length, ' ');
+				add(nullptr, length);
+			}
+
+			/**
+			 * 	@brief	Method get_vectors gets the blocks of output to write, once all output has been added.
+			 * 	@return	const std::pmr::vector<iovec>& blocks of output in order.
+			 */
+			const std::pmr::vector<iovec>& get_vectors() {
+				// Point the blocks copied to the scratch buffer into it, now that it won't reallocate.
+				size_t offset = 0;
+				for (iovec& vector : vectors) {
+					if (vector.iov_base == nullptr) {
+						vector.iov_base = scratch.data() + offset;
+						offset += vector.iov_len;
 					}
-					// Print the message to the console.
-					print(message, name, severity);
 				}
+				return vectors;
 			}
-		}
+
+			/**
+			 * 	@brief	Method length gets the total length of the output.
+			 * 	@return	size_t length of the output in bytes.
+			 */
+			size_t length() const {
+				return output_length;
+			}
+
+		private:
+			/// Length in bytes from which pieces of output are referenced rather than copied.
+			const static inline size_t REFERENCE_LENGTH = 256;
+			/// Buffer that short pieces of output are copied to.
+			std::pmr::string scratch;
+			/// Blocks of output, where blocks in the scratch buffer have a null base until get_vectors.
+			std::pmr::vector<iovec> vectors;
+			/// Total length of the output in bytes.
+			size_t output_length = 0;
+
+			/**
+			 * 	@brief	Method add adds a block to the output, merging it with the last block if both are in the 
+			 * 			scratch buffer.
+			 * 	@param	data 	const char* start of the block, or nullptr for the end of the scratch buffer.
+			 * 	@param	length 	size_t length of the block in bytes.
+			 */
+			void add(const char* data, size_t length) {
+				if (length == 0) {
+					return;
+				}
+				if (data == nullptr && !vectors.empty() && vectors.back().iov_base == nullptr) {
+					vectors.back().iov_len += length;
+				}
+				else {
+					vectors.push_back(iovec{const_cast<char*>(data), length});
+				}
+				output_length += length;
+			}
+		};
+
+		/**
+		 * 	@class	output_sink
+		 * 	@brief	Class output_sink writes formatted output to a file descriptor, collecting it in a large buffer 
+		 * 			when the descriptor is not a terminal.
+		 * 	@details	The console singleton shares the sink for stdout with print, and each independent console 
+		 * 				writes to a sink of its own. Only the sink for stdout draws the status line.
+		 */
+		class output_sink {
+		public:
+			/**
+			 * 	@brief	Constructor for the output_sink class, which detects whether the descriptor is a terminal.
+			 * 	@param	descriptor 	int file descriptor to write to (ignored on Windows, where stdout is used).
+			 */
+			explicit output_sink(int descriptor) :
+				descriptor(descriptor),
+				terminal(is_terminal_descriptor(descriptor)),
+				colour(terminal.load() && std::getenv("NO_COLOR") == nullptr),
+				flushed_later(false)
+			{}
+
+			/// Deleted cloning constructor.
+			output_sink(const output_sink&) = delete;
+			/// Deleted assignment operator.
+			void operator=(const output_sink&) = delete;
+
+			/// Mutex to lock writing to the sink between threads, so output doesn't get garbled.
+			threading::mutex mutex;
+
+			/**
+			 * 	@brief 	Method write writes formatted output to the sink.
+			 * 	@details	When the sink is a terminal the output is written straight away so it is seen with 
+			 * 				line-level latency, as it is when nothing will flush a buffer in time. Otherwise it is 
+			 * 				collected in a large buffer which is written in a single call once it is full, or once 
+			 * 				OUTPUT_FLUSH_INTERVAL has passed since the oldest output in it. Output that is written 
+			 * 				straight away is written with a single gathered write.
+			 * 	@param 	output 		gather_buffer formatted output to write.
+			 * 	@param 	immediate 	bool true to write the output and anything buffered before it straight away.
+			 */
+			void write(gather_buffer& output, bool immediate = false) {
+				std::scoped_lock<threading::mutex> lock(mutex);
+				const std::pmr::vector<iovec>& vectors = output.get_vectors();
+
+				// If the sink is a terminal, or there is nothing to flush a buffer later, write the output straight 
+				// away.
+				if (terminal || immediate || !flushed_later.load()) {
+					flush_buffer();
+					// If a status line is shown, insert the output above it and redraw it.
+					if (this == &standard_output && !status_line.empty()) {
+						write_direct(ERASE_LINE);
+						write_direct(vectors.data(), vectors.size());
+						write_direct(status_line);
+					}
+					else {
+						write_direct(vectors.data(), vectors.size());
+					}
+					return;
+				}
+
+				// If the output doesn't fit in the buffer, make room for it.
+				auto now = std::chrono::steady_clock::now();
+				if (buffer.size() + output.length() > OUTPUT_BUFFER_SIZE) {
+					flush_buffer();
+				}
+
+				// If the output is large, write it directly rather than copying it into the buffer.
+				if (output.length() >= DIRECT_WRITE_SIZE) {
+					flush_buffer();
+					write_direct(vectors.data(), vectors.size());
+				}
+				// Otherwise append it to the buffer, noting the time if it is the oldest output.
+				else {
+					if (buffer.empty()) {
+						buffer.reserve(OUTPUT_BUFFER_SIZE);
+						buffer_time = now;
+					}
+					for (const iovec& vector : vectors) {
+						buffer.append(static_cast<const char*>(vector.iov_base), vector.iov_len);
+					}
+				}
+
+				// If the oldest output has been waiting too long, flush the buffer.
+				if (now - buffer_time >= OUTPUT_FLUSH_INTERVAL) {
+					flush_buffer();
+				}
+			}
+
+			/**
+			 * 	@brief 	Method flush writes any output that has been buffered.
+			 */
+			void flush() {
+				std::scoped_lock<threading::mutex> lock(mutex);
+				flush_buffer();
+			}
+
+			/**
+			 * 	@brief 	Method flush_buffer writes and empties the buffer.
+			 * 	@note	The sink's mutex must be held when calling this method.
+			 */
+			void flush_buffer() {
+				if (!buffer.empty()) {
+					write_direct(buffer);
+					buffer.clear();
+				}
+			}
+
+			/**
+			 * 	@brief 	Method discard_buffer empties the buffer without writing it, as in a forked child.
+			 * 	@note	The sink's mutex must be held when calling this method.
+			 */
+			void discard_buffer() {
+				buffer.clear();
+			}
+
+			/**
+			 * 	@brief 	Method set_descriptor changes the descriptor written to, flushing the buffer to the old one 
+			 * 			and detecting whether the new one is a terminal.
+			 * 	@param 	new_descriptor 	int file descriptor to write to.
+			 * 	@note	The sink's mutex must be held when calling this method.
+			 */
+			void set_descriptor(int new_descriptor) {
+				if (new_descriptor != descriptor.load()) {
+					flush_buffer();
+					descriptor.store(new_descriptor);
+					terminal.store(is_terminal_descriptor(new_descriptor));
+					colour.store(terminal.load() && std::getenv("NO_COLOR") == nullptr);
+				}
+			}
+
+			/**
+			 * 	@brief 	Method is_terminal checks if the sink is an interactive terminal.
+			 * 	@return bool true if the sink is a terminal, false if it is a pipe or file.
+			 */
+			bool is_terminal() const {
+				return terminal.load(std::memory_order_relaxed);
+			}
+
+			/**
+			 * 	@brief 	Method is_colour checks if the severity column is coloured with ANSI escape codes.
+			 * 	@return bool true if the severity column is coloured.
+			 */
+			bool is_colour() const {
+				return colour.load(std::memory_order_relaxed);
+			}
+
+			/**
+			 * 	@brief 	Method set_colour sets whether the severity column is coloured with ANSI escape codes.
+			 * 	@param 	enabled 	bool true to colour the severity column.
+			 */
+			void set_colour(bool enabled) {
+				colour.store(enabled, std::memory_order_relaxed);
+			}
+
+			/**
+			 * 	@brief 	Method set_flushed_later sets whether something will flush buffered output, which is the 
+			 * 			print thread of the sink's console, or in single threaded builds the console itself.
+			 * 	@param 	enabled 	bool true if output can be held in the buffer.
+			 */
+			void set_flushed_later(bool enabled) {
+				flushed_later.store(enabled);
+			}
+
+			/**
+			 * 	@brief 	Method write_direct writes a block of bytes to the descriptor.
+			 * 	@param 	data 	std::string_view bytes to write.
+			 */
+			void write_direct(std::string_view data) {
+				iovec vector {const_cast<char*>(data.data()), data.length()};
+				write_direct(&vector, 1);
+			}
+
+			/**
+			 * 	@brief 	Method write_direct writes blocks of bytes to the descriptor in as few system calls as possible.
+			 * 	@param 	vectors const iovec* blocks to write.
+			 * 	@param 	count 	size_t number of blocks to write.
+			 */
+			void write_direct(const iovec* vectors, size_t count) {
+				// Flush anything written through std::cout first so output stays in order.
+				std::cout.flush();
+#ifdef _WIN32
+				for (size_t i = 0; i < count; i++) {
+					std::cout.write(static_cast<const char*>(vectors[i].iov_base), vectors[i].iov_len);
+				}
+				std::cout.flush();
+#else
+				while (count > 0) {
+					ssize_t bytes_written = ::writev(descriptor.load(std::memory_order_relaxed), vectors, static_cast<int>(std::min(count, MAX_WRITE_VECTORS)));
+					if (bytes_written < 0) {
+						// Retry if interrupted by a signal, otherwise drop the output.
+						if (errno == EINTR) {
+							continue;
+						}
+						return;
+					}
+
+					// Skip the blocks that were written completely.
+					while (count > 0 && static_cast<size_t>(bytes_written) >= vectors->iov_len) {
+						bytes_written -= vectors->iov_len;
+						vectors++;
+						count--;
+					}
+
+					// If a block was only partly written, write the rest of it on its own.
+					if (bytes_written > 0) {
+						write_direct(std::string_view(static_cast<const char*>(vectors->iov_base) + bytes_written, 
+							vectors->iov_len - bytes_written));
+						vectors++;
+						count--;
+					}
+				}
+#endif
+			}
+
+		private:
+			/// File descriptor the output is written to.
+			threading::atomic<int> descriptor;
+			/// Flag for if the descriptor is an interactive terminal, detected when it is set.
+			threading::atomic<bool> terminal;
+			/// Flag for if the severity column is coloured.
+			threading::atomic<bool> colour;
+			/// Flag for if something will flush buffered output.
+			threading::atomic<bool> flushed_later;
+			/// Buffer of output waiting to be written when the descriptor is not a terminal.
+			std::string buffer;
+			/// Time that the oldest output in the buffer was printed.
+			std::chrono::steady_clock::time_point buffer_time;
+
+			/**
+			 * 	@brief 	Static method is_terminal_descriptor checks if a descriptor is an interactive terminal.
+			 * 	@param 	checked 	int file descriptor to check.
+			 * 	@return bool true if the descriptor is a terminal, false if it is a pipe or file.
+			 */
+			static bool is_terminal_descriptor([[maybe_unused]] int checked) {
+#ifdef _WIN32
+				return _isatty(_fileno(stdout));
+#else
+				return isatty(checked);
+#endif
+			}
+		};
+
+		/**
+		 * 	@brief	Struct throw_site_hash hashes throw sites to count repeated exceptions, by the name of the file 
+		 * 			rather than where it is stored, as each translation unit may have its own copy of a name.
+		 */
+		struct throw_site_hash {
+			size_t operator()(const exception::throw_site& site) const noexcept {
+				size_t hash = std::hash<std::string_view>()(site.file != nullptr ? site.file : "");
+				hash ^= std::hash<unsigned int>()(site.line) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				hash ^= (site.type != nullptr ? site.type->hash_code() : 0) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				return hash;
+			}
+		};
+
+		/**
+		 * 	@brief	Struct exception_site_state counts the exceptions from a throw site in the current window.
+		 * 	@details	The throwing threads claim a state for the site and count against it, so repeats beyond the 
+		 * 				limit are dropped before anything is copied or queued. The print thread reports the 
+		 * 				suppressed counts, with the name and severity it last printed for the site.
+		 */
+		struct exception_site_state {
+			/// Hash of the site the state counts, or 0 if the state is unclaimed.
+			threading::atomic<size_t> key{0};
+			/// File of the site, set by the thread that claimed the state.
+			threading::atomic<const char*> file{nullptr};
+			/// Line of the site, set by the thread that claimed the state.
+			threading::atomic<unsigned int> line{0};
+			/// Time the current window started, in nanoseconds of std::chrono::steady_clock.
+			threading::atomic<int64_t> window_start{0};
+			/// Number of exceptions admitted to be printed in the current window.
+			threading::atomic<unsigned int> admitted{0};
+			/// Number of exceptions suppressed since the print thread last reported them.
+			threading::atomic<uint64_t> suppressed{0};
+			/// Time the print thread last reported the suppressed exceptions, or first saw them if it hasn't yet.
+			std::chrono::steady_clock::time_point reported{};
+			/// Name of the component that last threw from the site, used by the print thread.
+			std::string name = "LogConsole";
+			/// Severity of the last exception from the site, used by the print thread.
+			logging::severity severity = logging::severity::error;
+		};
+
+		/**
+		 * 	@class	line_view
+		 * 	@brief	Class line_view is a view of a single line of a message, which may be split across several 
+		 * 			segments of the message.
+		 */
+		class line_view {
+		public:
+			/**
+			 * 	@brief	Method clear empties the line, keeping its storage for reuse.
+			 */
+			void clear() {
+				pieces.clear();
+				line_length = 0;
+			}
+
+			/**
+			 * 	@brief	Method add adds a piece to the end of the line.
+			 * 	@param	piece 	std::string_view piece of the line.
+			 */
+			void add(std::string_view piece) {
+				if (!piece.empty()) {
+					pieces.push_back(piece);
+					line_length += piece.length();
+				}
+			}
+
+			/**
+			 * 	@brief	Method length gets the length of the line.
+			 * 	@return	size_t length of the line in bytes.
+			 */
+			size_t length() const {
+				return line_length;
+			}
+
+			/**
+			 * 	@brief	Operator [] gets a character of the line.
+			 * 	@param	position 	size_t position of the character in the line.
+			 * 	@return	char character at the position, or '\0' if it is past the end of the line.
+			 */
+			char operator[](size_t position) const {
+				for (const std::string_view& piece : pieces) {
+					if (position < piece.length()) {
+						return piece[position];
+					}
+					position -= piece.length();
+				}
+				return '\0';
+			}
+
+			/**
+			 * 	@brief	Method rfind finds the last occurrence of a character at or before a position in the line.
+			 * 	@param	character 	char character to find.
+			 * 	@param	position 	size_t position to search backwards from.
+			 * 	@return	size_t position of the character, or std::string_view::npos if it was not found.
+			 */
+			size_t rfind(char character, size_t position) const {
+				if (line_length == 0) {
+					return std::string_view::npos;
+				}
+				position = std::min(position, line_length - 1);
+
+				// Search the pieces from the one containing the position backwards.
+				size_t piece_start = line_length;
+				for (size_t i = pieces.size(); i-- > 0;) {
+					piece_start -= pieces[i].length();
+					if (position < piece_start) {
+						continue;
+					}
+					size_t found = pieces[i].rfind(character, position - piece_start);
+					if (found != std::string_view::npos) {
+						return piece_start + found;
+					}
+					if (piece_start == 0) {
+						break;
+					}
+					position = piece_start - 1;
+				}
+				return std::string_view::npos;
+			}
+
+			/**
+			 * 	@brief	Method append_to adds part of the line to an output buffer.
+			 * 	@param	output 		gather_buffer to add the part of the line to.
+			 * 	@param	position 	size_t position of the start of the part in the line.
+			 * 	@param	length 		size_t length of the part, which is clamped to the end of the line.
+			 */
+			void append_to(gather_buffer& output, size_t position, size_t length) const {
+				for (const std::string_view& piece : pieces) {
+					if (length == 0) {
+						break;
+					}
+					if (position >= piece.length()) {
+						position -= piece.length();
+						continue;
+					}
+					size_t piece_length = std::min(length, piece.length() - position);
+					output.append(piece.substr(position, piece_length));
+					position = 0;
+					length -= piece_length;
+				}
+			}
+
+		private:
+			/// Pieces of the line in order.
+			std::vector<std::string_view> pieces;
+			/// Total length of the line in bytes.
+			size_t line_length = 0;
+		};
+
+		/*************************************************************************************************/
+		/* Static Members																				 */
+		/*************************************************************************************************/
+		/// Width of the name column until longer names are seen.
+		const static inline unsigned int DEFAULT_NAME_WIDTH = 40;
+		/// Maximum number of messages drain prints between checks of its time limit.
+		const static inline size_t DRAIN_BATCH_SIZE = 256;
+		/// Number of throw sites whose repeated exceptions are counted, beyond which exceptions are all printed.
+		const static inline size_t EXCEPTION_SITES = 256;
+		/// Number of states looked at for a throw site before it is treated as not counted.
+		const static inline size_t EXCEPTION_SITE_PROBES = 8;
+		/// Number of milliseconds to timeout after when waiting on condition variables.
+		const static inline std::chrono::milliseconds WAIT_TIMEOUT_MS = std::chrono::milliseconds(100);;
+		/// Maximum severity width in characters seen so far.
+		static unsigned int max_severity_width;
+		/// Maximum name width in characters seen so far.
+		inline static unsigned int max_name_width = DEFAULT_NAME_WIDTH;
+		/// Minimum width in characters left for the message before lines are wrapped.
+		const static inline size_t MIN_WRAP_WIDTH = 20;
+		/// Cached width of the console in characters, or 0 if stdout is not a terminal and lines are not wrapped.
+		inline static threading::atomic<unsigned int> console_width{0};
+		/// Flag for if the console width has been initialised, which is done when it is first needed.
+		inline static threading::once_flag console_width_flag;
+		/// Size in bytes of the buffer that output is collected in when stdout is not a terminal.
+		const static inline size_t OUTPUT_BUFFER_SIZE = 64 * 1024;
+		/// Size in bytes from which output is written directly, rather than copied into the output buffer.
+		const static inline size_t DIRECT_WRITE_SIZE = 16 * 1024;
+		/// Size in bytes of the name and message prefaulted for each queued message, when they are too long to be 
+		/// stored in place.
+		const static inline size_t PREFAULT_MESSAGE_SIZE = 512;
+#ifdef IOV_MAX
+		/// Maximum number of blocks in a single gathered write.
+		const static inline size_t MAX_WRITE_VECTORS = IOV_MAX;
+#else
+		/// Maximum number of blocks in a single gathered write.
+		const static inline size_t MAX_WRITE_VECTORS = 1024;
+#endif
+		/// Escape sequence to return to the start of the line and erase it.
+		constexpr static std::string_view ERASE_LINE = "\r\033[K";
+		/// Maximum time that output is held in the buffer before it is flushed.
+		const static inline std::chrono::milliseconds OUTPUT_FLUSH_INTERVAL = std::chrono::milliseconds(100);
+		/// Sink for stdout, shared by print and the console singleton.
+		inline static output_sink standard_output{1};
+		/// Memory resource the console singleton is created with, or nullptr for the default resource.
+		inline static threading::atomic<std::pmr::memory_resource*> initial_memory_resource{nullptr};
+		/// Window in milliseconds that repeated exceptions from the same site are counted over.
+		inline static threading::atomic<int64_t> exception_window{1000};
+		/// Number of exceptions from the same site printed per window.
+		inline static threading::atomic<unsigned int> exception_limit{1};
+		/// Mutex to protect access to the status text.
+		inline static threading::mutex status_mutex;
+		/// Text of the status line.
+		inline static std::string status_text;
+		/// Version of the status text, incremented each time it is set.
+		inline static threading::atomic<unsigned int> status_version{0};
+		/// Progress shown on the status line.
+		inline static threading::atomic<uint64_t> status_progress{0};
+		/// Total progress shown on the status line, or 0 for no progress bar.
+		inline static threading::atomic<uint64_t> status_total{0};
+		/// Flag for if the status line should be shown.
+		inline static threading::atomic<bool> status_active{false};
+		/// Maximum number of times per second the status line is redrawn.
+		inline static threading::atomic<unsigned int> status_refresh_rate{10};
+		/// Status line currently drawn on the console, protected by the mutex of the sink for stdout.
+		inline static std::string status_line;
+		/// Width in characters of the status line progress bar.
+		const static inline size_t STATUS_BAR_WIDTH = 20;
+		/// Width in characters of the severity column, i.e. "[WARNING]  ".
+		const static inline size_t SEVERITY_COLUMN_WIDTH = 11;
+		/// Precomputed plain severity columns, indexed by severity.
+		constexpr static std::string_view SEVERITY_COLUMNS[] = {
+			"[INFO]     ",
+			"[WARNING]  ",
+			"[ERROR]    "
+		};
+		/// Precomputed coloured severity columns, indexed by severity.
+		constexpr static std::string_view COLOURED_SEVERITY_COLUMNS[] = {
+			"[INFO]     ",
+			"[\033[33mWARNING\033[0m]  ",
+			"[\033[31mERROR\033[0m]    "
+		};
+#ifndef _WIN32
+		/// Action that was registered for SIGWINCH before the console installed its own handler.
+		inline static struct sigaction previous_window_change_action{};
+#endif
+		/// Mutex to protect the list of consoles that are alive.
+		inline static threading::mutex instances_mutex;
+		/// First of the consoles that are alive, which the fork handlers quiesce, linked by next_instance.
+		inline static console_base* first_instance = nullptr;
+
+		/*************************************************************************************************/
+		/* Non-Static Members																			 */
+		/*************************************************************************************************/
+		/// Next console in the list of consoles that are alive.
+		console_base* next_instance = nullptr;
+
+		/*************************************************************************************************/
+		/* Non-Static Methods																			 */
+		/*************************************************************************************************/
+		/// Protected constructor for the console_base class, which is only constructed by basic_console.
+		console_base() = default;
+		/// Protected destructor for the console_base class, as consoles aren't destroyed through it.
+		~console_base() = default;
+		/// Deleted cloning constructor.
+		console_base(const console_base&) = delete;
+		/// Deleted assignment operator.
+		void operator=(const console_base&) = delete;
+
+		/**
+		 *	@brief	Method link_instance adds the console to the list of consoles that are alive, once it is 
+		 *			constructed, registering the fork handlers the first time.
+		 */
+		void link_instance() {
+#ifndef _WIN32
+			// Register the fork handlers once, for the life of the process.
+			static const bool fork_handlers_registered = 
+				pthread_atfork(&console_base::prepare_fork, &console_base::after_fork_parent, &console_base::after_fork_child) == 0;
+			(void)fork_handlers_registered;
+#endif
+			std::scoped_lock<threading::mutex> instances_lock(instances_mutex);
+			next_instance = first_instance;
+			first_instance = this;
+		}
+
+		/**
+		 *	@brief	Method unlink_instance removes the console from the list of consoles that are alive, before it 
+		 *			is destroyed.
+		 */
+		void unlink_instance() {
+			std::scoped_lock<threading::mutex> instances_lock(instances_mutex);
+			console_base** link = &first_instance;
+			while (*link != this) {
+				link = &(*link)->next_instance;
+			}
+			*link = next_instance;
+		}
+
+		/// Method lock_for_fork takes the locks of the console's queue and print thread, in order, before fork.
+		virtual void lock_for_fork() = 0;
+		/// Method lock_storage_for_fork takes the locks of the console's own sink and chunk pool before fork.
+		virtual void lock_storage_for_fork() = 0;
+		/// Method unlock_storage_after_fork releases the locks taken by lock_storage_for_fork.
+		virtual void unlock_storage_after_fork() = 0;
+		/// Method unlock_after_fork releases the locks taken by lock_for_fork.
+		virtual void unlock_after_fork() = 0;
+		/**
+		 *	@brief	Method reset_after_fork resets the console in a child process, which only has the thread that 
+		 *			called fork.
+		 *	@return	bool true if the console has queued messages to print.
+		 */
+		virtual bool reset_after_fork() = 0;
+		/// Method discard_after_fork drops the messages a console doesn't keep in a child process, once the fork 
+		/// locks have been released, as freeing their chunks takes the chunk pool's lock.
+		virtual void discard_after_fork() = 0;
+		/// Method resume_after_fork starts printing the messages a console kept in a child process.
+		virtual void resume_after_fork() = 0;
+
+#ifndef _WIN32
+		/**
+		 *	@brief	Static method prepare_fork quiesces the consoles before fork, by taking every lock in order so 
+		 *			no other thread is part way through queueing or printing a message.
+		 */
+		static void prepare_fork() {
+			instances_mutex.lock();
+			for (console_base* instance = first_instance; instance != nullptr; instance = instance->next_instance) {
+				instance->lock_for_fork();
+			}
+			status_mutex.lock();
+			standard_output.mutex.lock();
+			for (console_base* instance = first_instance; instance != nullptr; instance = instance->next_instance) {
+				instance->lock_storage_for_fork();
+			}
+			stack_trace::lock();
+		}
+
+		/**
+		 *	@brief	Static method release_fork_locks releases the locks taken by prepare_fork.
+		 */
+		static void release_fork_locks() {
+			stack_trace::unlock();
+			for (console_base* instance = first_instance; instance != nullptr; instance = instance->next_instance) {
+				instance->unlock_storage_after_fork();
+			}
+			standard_output.mutex.unlock();
+			status_mutex.unlock();
+			for (console_base* instance = first_instance; instance != nullptr; instance = instance->next_instance) {
+				instance->unlock_after_fork();
+			}
+			instances_mutex.unlock();
+		}
+
+		/**
+		 *	@brief	Static method after_fork_parent releases the locks taken by prepare_fork in the parent.
+		 */
+		static void after_fork_parent() {
+			release_fork_locks();
+		}
+
+		/**
+		 *	@brief	Static method after_fork_child resets the consoles in a child process, which only has the 
+		 *			thread that called fork, then starts new print threads for consoles with messages to print.
+		 *	@details	The queued messages are kept or dropped by each console's fork policy, output buffered 
+		 *				by the parent is dropped so it isn't written twice, and the status line is hidden until 
+		 *				the child sets it.
+		 */
+		static void after_fork_child() {
+			status_active.store(false);
+			status_line.clear();
+			standard_output.discard_buffer();
+			std::vector<console_base*> instances;
+			std::vector<console_base*> pending;
+			for (console_base* instance = first_instance; instance != nullptr; instance = instance->next_instance) {
+				instances.push_back(instance);
+				if (instance->reset_after_fork()) {
+					pending.push_back(instance);
+				}
+			}
+
+			release_fork_locks();
+			for (console_base* instance : instances) {
+				instance->discard_after_fork();
+			}
+			for (console_base* instance : pending) {
+				instance->resume_after_fork();
+			}
+		}
+#endif
+
+		/**
+		 *	@brief	Static method warn_thread_config prints a warning that a thread setting couldn't be applied.
+		 *	@param	setting 	std::string_view name of the setting.
+		 *	@param	error 		int error number returned when applying it.
+		 */
+		static void warn_thread_config(std::string_view setting, int error) {
+			std::string message = "Could not set the print thread ";
+			message.append(setting);
+			message.append(": ");
+			message.append(std::strerror(error));
+			print(message, "LogConsole", severity::warning);
+		}
+
+		/**
+		 *	@brief	Static method lock_pages locks a block of memory into memory, so it is never paged out.
+		 *	@param	start 	const void* start of the block.
+		 *	@param	bytes 	size_t length of the block in bytes.
+		 *	@return	int 0 if the block was locked, or else the error number.
+		 */
+		static int lock_pages(const void* start, size_t bytes) {
+			if (start == nullptr || bytes == 0) {
+				return 0;
+			}
+#ifdef _WIN32
+			return VirtualLock(const_cast<void*>(start), bytes) ? 0 : static_cast<int>(GetLastError());
+#else
+			return mlock(start, bytes) == 0 ? 0 : errno;
+#endif
+		}
+
+		/**
+		 *	@brief	Static method warn_lock_failed prints a warning that the console's memory couldn't be locked.
+		 *	@param	error 	int error number returned when locking it.
+		 */
+		static void warn_lock_failed(int error) {
+			std::string message = "Could not lock the console's memory: ";
+			message.append(std::strerror(error));
+			print(message, "LogConsole", severity::warning);
+		}
+
+		/**
+		 *	@brief	Static method reconstruct replaces a container with an empty one allocated from another memory 
+		 *			resource, which assignment can't do as polymorphic allocators aren't propagated.
+		 *	@param	container 	container to replace.
+		 *	@param	resource 	std::pmr::memory_resource* resource for the new container to allocate from.
+		 */
+		template <typename Container>
+		static void reconstruct(Container& container, std::pmr::memory_resource* resource) {
+			container.~Container();
+			new (&container) Container(resource);
+		}
 
 		/*************************************************************************************************/
-		/* Static Methods																				 */
-		/*************************************************************************************************/
+		/* Static Methods																				 */
+		/*************************************************************************************************/
+		/**
+		 * 	@brief 	Static method layout lays a message out in an output buffer, in the format printed to the 
+		 * 			console.
+		 * 	@details	The preamble is built from precomputed fragments and padding, and the lines of the message 
+		 * 				are added as views into the message, so long lines are not copied.
+		 * 	@param 	message 	string message to lay out.
+		 * 	@param 	name 		string name of the component printing the message.
+		 * 	@param 	severity	logging::severity of the message.
+		 * 	@param 	time 		std::chrono::system_clock::time_point time to timestamp the message with.
+		 * 	@param 	output 		gather_buffer to add the formatted message to.
+		 * 	@param 	line 		line_view to collect each line of the message in, kept by the caller for reuse.
+		 * 	@param 	max_name 	unsigned int maximum name width seen so far, which is updated with the name.
+		 * 	@param 	colour 		bool true to colour the severity column.
+		 * 	@param 	width 		unsigned int width of the sink in characters that lines are wrapped at, or 0 to not 
+		 * 						wrap them.
+		 */
+		static void layout(
+			std::string_view message, 
+			std::string_view name,
+			const severity severity,
+			std::chrono::system_clock::time_point time,
+			gather_buffer& output,
+			line_view& line,
+			unsigned int& max_name,
+			bool colour,
+			unsigned int width) 
+		{
+			layout(&message, 1, name, severity, time, output, line, max_name, colour, width);
+		}
+
+		/**
+		 * 	@brief 	Static method layout lays a message made of several segments out in an output buffer, in the 
+		 * 			format printed to the console.
+		 * 	@param 	segments 		const std::string_view* segments of the message in order, where lines of the 
+		 * 							message can be split across segments.
+		 * 	@param 	segment_count 	size_t number of segments.
+		 * 	@param 	name 			string name of the component printing the message.
+		 * 	@param 	severity		logging::severity of the message.
+		 * 	@param 	time 			std::chrono::system_clock::time_point time to timestamp the message with.
+		 * 	@param 	output 			gather_buffer to add the formatted message to.
+		 * 	@param 	line 			line_view to collect each line of the message in, kept by the caller for reuse.
+		 * 	@param 	max_name 		unsigned int maximum name width seen so far, which is updated with the name.
+		 * 	@param 	colour 			bool true to colour the severity column.
+		 * 	@param 	width 			unsigned int width of the sink in characters that lines are wrapped at, or 0 
+		 * 							to not wrap them.
+		 */
+		static void layout(
+			const std::string_view* segments, 
+			size_t segment_count,
+			std::string_view name,
+			const severity severity,
+			std::chrono::system_clock::time_point time,
+			gather_buffer& output,
+			line_view& line,
+			unsigned int& max_name,
+			bool colour,
+			unsigned int width) 
+		{
+			// Update the maximum name width.
+			max_name = std::max(max_name, (unsigned int)name.length());
+
+			// Generate the timestamp for the message.
+			char timestamp_buffer[time_template_width];
+			std::string_view timestamp(timestamp_buffer, write_timestamp(timestamp_buffer, time));
+
+			// Get the precomputed severity column, coloured if printing to a terminal.
+			std::string_view severity_column = get_severity_column(severity, colour);
+
+			// Print the preamble of the first line in the format:
+			// [TIME] [SEVERITY] (NAME) 
+			size_t time_width = std::max<size_t>(timestamp.length() + 1, time_template_width);
+			size_t name_width = std::max<size_t>(name.length() + 1, max_name + 2);
+			output.append("[");
+			output.append(timestamp);
+			output.append("]");
+			output.pad(time_width - timestamp.length() - 1);
+			output.append(severity_column);
+			output.append("(");
+			output.append(name);
+			output.append(")");
+			output.pad(name_width - name.length() - 1);
+
+			// Get the width of the preamble printed before the first line, not counting colour escape codes.
+			size_t preamble_width = 1 + time_width + SEVERITY_COLUMN_WIDTH + 1 + name_width;
+
+			// Get the width left for the message after the preamble, or 0 if lines should not be wrapped.
+			size_t wrap_width = (width >= preamble_width + MIN_WRAP_WIDTH) ? width - preamble_width : 0;
+
+			// Collect each line of the message from the segments, then write it to the output in line with the 
+			// message lines above it.
+			line.clear();
+			bool first_line = true;
+			for (size_t i = 0; i < segment_count; i++) {
+				std::string_view segment = segments[i];
+				size_t line_start = 0;
+				size_t line_end;
+				while ((line_end = segment.find('\n', line_start)) != std::string_view::npos) {
+					line.add(segment.substr(line_start, line_end - line_start));
+					if (!first_line) {
+						output.pad(preamble_width);
+					}
+					layout_wrapped_line(line, preamble_width, wrap_width, output);
+					line.clear();
+					first_line = false;
+					line_start = line_end + 1;
+				}
+				line.add(segment.substr(line_start));
+			}
+
+			// Write the last line of the message (there is guaranteed to be 1).
+			if (!first_line) {
+				output.pad(preamble_width);
+			}
+			layout_wrapped_line(line, preamble_width, wrap_width, output);
+		}
+
 		/**
 		 * @brief 	Method get_console_width gets the width of the console which will be printed to.
-		 * @return 	unsigned int width of the console in characters.
+		 * @return 	unsigned int width of the console in characters, or 0 if it could not be determined.
+		 * @note	This method is async-signal-safe on POSIX platforms so it can be called from the SIGWINCH 
+		 * 			handler.
 		 */
 		static unsigned int get_console_width() {
 #ifdef _WIN32
 			CONSOLE_SCREEN_BUFFER_INFO screen_buffer_info;
-			GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &screen_buffer_info);
+			if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &screen_buffer_info)) {
+				return 0;
+			}
 			return screen_buffer_info.dwSize.X;
 #else
-			struct winsize window_size_info;
-			ioctl(STDOUT_FILENO, TIOCGWINSZ, &window_size_info);
+			struct winsize window_size_info {};
+			if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &window_size_info) != 0) {
+				return 0;
+			}
 			return window_size_info.ws_col;
 #endif
 		}
-	};
 
-	// Mutex to lock access to the console between threads, so output doesn't get garbled.
-	std::mutex console::std_out_mutex;
-	/// Initialise the maximum name width to a long value.
-	unsigned int console::max_name_width = 40;
+		/**
+		 * @brief 	Method load_console_width gets the cached width of the console, initialising it the first time 
+		 * 			it is needed.
+		 * @return 	unsigned int width of the console in characters, or 0 if lines are not wrapped.
+		 */
+		static unsigned int load_console_width() {
+			threading::call_once(console_width_flag, &initialise_console_width);
+			return console_width.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief 	Method initialise_console_width caches the initial width of the console and, if stdout is a 
+		 * 			terminal, installs a SIGWINCH handler to keep the cached width up to date.
+		 * @note	This is called once by load_console_width, so programs that never print don't install the 
+		 * 			handler.
+		 */
+		static void initialise_console_width() {
+			// If stdout is not a terminal, never wrap lines.
+			if (!standard_output.is_terminal()) {
+				return;
+			}
+
+#ifndef _WIN32
+			// Install the handler, keeping the previous action so it can still be called.
+			struct sigaction action {};
+			action.sa_sigaction = &handle_window_change;
+			sigemptyset(&action.sa_mask);
+			action.sa_flags = SA_RESTART | SA_SIGINFO;
+			sigaction(SIGWINCH, &action, &previous_window_change_action);
+#endif
+			// Windows has no resize signal, so the width is only read once.
+			console_width.store(get_console_width(), std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief 	Method get_status_refresh_interval gets the minimum time between redraws of the status line.
+		 * @return 	std::chrono::milliseconds minimum time between redraws.
+		 */
+		static std::chrono::milliseconds get_status_refresh_interval() {
+			return std::chrono::milliseconds(1000 / status_refresh_rate.load(std::memory_order_relaxed));
+		}
+
+		/**
+		 * @brief 	Method get_severity_column gets the precomputed severity column for a severity.
+		 * @param 	severity 	logging::severity of the message.
+		 * @param 	colour 		bool true to get the column with ANSI colour escape codes.
+		 * @return 	std::string_view severity column, SEVERITY_COLUMN_WIDTH characters wide when displayed.
+		 */
+		static std::string_view get_severity_column(severity severity, bool colour) {
+			if (severity > severity::error) {
+				return "[]         ";
+			}
+			return colour ? COLOURED_SEVERITY_COLUMNS[severity] : SEVERITY_COLUMNS[severity];
+		}
+
+		/**
+		 * @brief 	Method get_cpu_nodes gets the NUMA node of each CPU, read from sysfs once.
+		 * @return 	const std::vector<unsigned int>& node of each CPU indexed by CPU, which is empty if the nodes 
+		 * 			can't be read, e.g. on other platforms.
+		 */
+		static const std::vector<unsigned int>& get_cpu_nodes() {
+			static const std::vector<unsigned int> cpu_nodes = [] {
+				std::vector<unsigned int> nodes;
+#ifdef __linux__
+				for (unsigned int node : read_cpu_list("/sys/devices/system/node/possible")) {
+					std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+					for (unsigned int cpu : read_cpu_list(path.c_str())) {
+						if (cpu >= nodes.size()) {
+							nodes.resize(cpu + 1, 0);
+						}
+						nodes[cpu] = node;
+					}
+				}
+#endif
+				return nodes;
+			}();
+			return cpu_nodes;
+		}
+
+		/**
+		 * @brief 	Method get_node_count gets the number of NUMA nodes, including nodes without CPUs.
+		 * @return 	unsigned int number of nodes, which is 1 if the nodes can't be read.
+		 */
+		static unsigned int get_node_count() {
+			const std::vector<unsigned int>& cpu_nodes = get_cpu_nodes();
+			return cpu_nodes.empty() ? 1 : *std::max_element(cpu_nodes.begin(), cpu_nodes.end()) + 1;
+		}
+
+		/**
+		 * @brief 	Method get_current_node gets the NUMA node of the CPU the calling thread is running on.
+		 * @return 	unsigned int node of the CPU, or 0 if it can't be found.
+		 * @note	This reads the CPU from the kernel's restartable sequence area or the vDSO, so it doesn't make a 
+		 * 			system call.
+		 */
+		static unsigned int get_current_node() {
+#ifdef __linux__
+			const std::vector<unsigned int>& cpu_nodes = get_cpu_nodes();
+			int cpu = sched_getcpu();
+			if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_nodes.size()) {
+				return cpu_nodes[cpu];
+			}
+#endif
+			return 0;
+		}
+
+		/**
+		 * @brief 	Method run_on_node calls a function from a thread running on a NUMA node's CPUs, so memory it 
+		 * 			touches first is placed on that node.
+		 * @param 	node 		unsigned int node to run the function on.
+		 * @param 	function 	function to call, which has returned when this method returns.
+		 * @note	The function is called from the calling thread if the node has no CPUs, on other platforms 
+		 * 			and in single threaded builds.
+		 */
+		template <typename Function>
+		static void run_on_node([[maybe_unused]] unsigned int node, Function&& function) {
+#if defined(__linux__) && !defined(LOGGING_SINGLE_THREADED)
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			const std::vector<unsigned int>& cpu_nodes = get_cpu_nodes();
+			for (size_t cpu = 0; cpu < cpu_nodes.size() && cpu < CPU_SETSIZE; cpu++) {
+				if (cpu_nodes[cpu] == node) {
+					CPU_SET(cpu, &cpus);
+				}
+			}
+			if (CPU_COUNT(&cpus) > 0) {
+				std::thread toucher([&] {
+					pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+					function();
+				});
+				toucher.join();
+				return;
+			}
+#endif
+			function();
+		}
+
+		/**
+		 * @brief 	Method read_cpu_list reads a list of CPUs or nodes in the kernel's list format, e.g. "0-3,8-11".
+		 * @param 	path 	const char* path of the file to read.
+		 * @return 	std::vector<unsigned int> numbers in the list, which is empty if the file can't be read.
+		 */
+		static std::vector<unsigned int> read_cpu_list(const char* path) {
+			std::vector<unsigned int> numbers;
+			FILE* file = std::fopen(path, "r");
+			if (file == nullptr) {
+				return numbers;
+			}
+			unsigned int first;
+			unsigned int last;
+			while (std::fscanf(file, "%u", &first) == 1) {
+				last = first;
+				int separator = std::fgetc(file);
+				if (separator == '-') {
+					if (std::fscanf(file, "%u", &last) != 1) {
+						break;
+					}
+					separator = std::fgetc(file);
+				}
+				for (unsigned int number = first; number <= last; number++) {
+					numbers.push_back(number);
+				}
+				if (separator != ',') {
+					break;
+				}
+			}
+			std::fclose(file);
+			return numbers;
+		}
+
+#ifndef _WIN32
+		/**
+		 * @brief 	Method handle_window_change is the SIGWINCH handler which refreshes the cached console width.
+		 * @param 	signal 	int number of the signal being handled.
+		 * @param 	info 	siginfo_t* information about the signal, passed on to a previous SA_SIGINFO handler.
+		 * @param 	context void* context of the interrupted code, passed on to a previous SA_SIGINFO handler.
+		 */
+		static void handle_window_change(int signal, siginfo_t* info, void* context) {
+			// Preserve errno for the interrupted code.
+			int saved_errno = errno;
+			console_width.store(get_console_width(), std::memory_order_relaxed);
+			errno = saved_errno;
+
+			// Chain to any handler that was installed before the console's, in the form it was installed with.
+			if (previous_window_change_action.sa_flags & SA_SIGINFO) {
+				if (previous_window_change_action.sa_sigaction != nullptr) {
+					previous_window_change_action.sa_sigaction(signal, info, context);
+				}
+			}
+			else if (previous_window_change_action.sa_handler != SIG_DFL && 
+				previous_window_change_action.sa_handler != SIG_IGN) {
+				previous_window_change_action.sa_handler(signal);
+			}
+		}
+#endif
+
+		/**
+		 * @brief 	Method layout_wrapped_line adds a single line of a message to the output, wrapping it onto 
+		 * 			continuation lines aligned with the message if it is longer than the wrap width.
+		 * @param 	line 			line_view line of the message to add (without a newline).
+		 * @param 	preamble_width 	size_t width of the preamble that continuation lines are indented by.
+		 * @param 	wrap_width 		size_t width in characters that the line is wrapped at, or 0 for no wrapping.
+		 * @param 	output 			gather_buffer to add the line to.
+		 */
+		static void layout_wrapped_line(
+			const line_view& line, 
+			size_t preamble_width, 
+			size_t wrap_width,
+			gather_buffer& output)
+		{
+			size_t position = 0;
+
+			// While the rest of the line does not fit in the wrap width,
+			while (wrap_width > 0 && line.length() - position > wrap_width) {
+				// Break at the last space that fits, or at the wrap width if there isn't one.
+				size_t length = wrap_width;
+				size_t space = line.rfind(' ', position + wrap_width);
+				if (space != std::string_view::npos && space > position) {
+					length = space - position;
+				}
+				// Don't break in the middle of a UTF-8 sequence.
+				while (length > 1 && (static_cast<unsigned char>(line[position + length]) & 0xC0) == 0x80) {
+					length--;
+				}
+
+				// Add the segment and indent the continuation line.
+				line.append_to(output, position, length);
+				output.append("\n");
+				output.pad(preamble_width);
+
+				// Skip the spaces that the line was broken at.
+				position += length;
+				while (position < line.length() && line[position] == ' ') {
+					position++;
+				}
+			}
+
+			// Add the rest of the line.
+			line.append_to(output, position, line.length() - position);
+			output.append("\n");
+		}
+	};
+
+	/**
+	 * 	@anchor		basic_console
+	 * 	@class 		basic_console
+	 * 	@brief 		Class basic_console is used to print formatted messages to the console, with its queue, overflow 
+	 * 				handling, clock and locking chosen at compile time.
+	 * 	@details	The class tracks the messages that have been sent previously along 
+	 * 				with the current size of the console, to print messages into columns
+	 * 				along with splitting multi-line messages accordingly. The output 
+	 * 				follows the format:
+	 * 				| [SEVERITY] (NAME) MESSAGE LINE 1				|
+	 * 				|					LONGER MESSAGE LINE 2 		|
+	 * 				|					EVEN LONGER MESSAGE LINE 2	|
+	 * 				| [SEVERITY] (NAME) MESSAGE LINE 1				|
+	 * 				logging::console is the instantiation with the default policies. Other instantiations have 
+	 * 				their own singleton, and share stdout, the status line and the name column of print with it. An 
+	 * 				example usage is included below.
+	 * 	@tparam		Capacity 		size_t number of messages the print queue holds, which is reserved when the 
+	 * 								console is constructed, or 0 for a queue that grows to fit.
+	 * 	@tparam		RecordSize 		size_t size in bytes of the chunks messages written with a record_writer are 
+	 * 								stored in.
+	 * 	@tparam		OverflowPolicy 	overflow::grow, overflow::block or overflow::drop, for what happens to a 
+	 * 								message when the print queue is full.
+	 * 	@tparam		ClockPolicy 	clocks::system or clocks::coarse, or any type with a static now method 
+	 * 								returning a std::chrono::system_clock::time_point, to timestamp messages with.
+	 * 	@tparam		LockPolicy 		mutex type protecting the print queue, e.g. threading::mutex or 
+	 * 								threading::spin_mutex.
+	 * 	@code {.cpp}
+	 * 	// A console for a latency critical thread, which never waits or allocates to queue a message.
+	 * 	using market_data_console = logging::basic_console<
+	 * 		4096, 
+	 * 		4096, 
+	 * 		logging::overflow::drop, 
+	 * 		logging::clocks::coarse, 
+	 * 		logging::threading::spin_mutex>;
+	 * 	market_data_console::get_instance().print_parallel("Book rebuilt.", "Market Data", logging::severity::info);
+	 * 	@endcode
+	 */
+	template <
+		size_t Capacity = 0, 
+		size_t RecordSize = 4096, 
+		typename OverflowPolicy = overflow::grow, 
+		typename ClockPolicy = clocks::system, 
+		typename LockPolicy = threading::mutex>
+	class basic_console : public console_base {
+		static_assert(RecordSize > sizeof(size_t), "RecordSize must leave room for a message in each chunk.");
+		static_assert(std::is_same_v<OverflowPolicy, overflow::grow> || std::is_same_v<OverflowPolicy, overflow::block> ||
+			std::is_same_v<OverflowPolicy, overflow::drop>, "OverflowPolicy must be overflow::grow, block or drop.");
+		static_assert(Capacity > 0 || std::is_same_v<OverflowPolicy, overflow::grow>, 
+			"A print queue that grows to fit can only use overflow::grow.");
+
+	public:
+		/*************************************************************************************************/
+		/* Non-Static Methods																			 */
+		/*************************************************************************************************/
+		/**
+		 * @brief 	Method get_instance retrieves the singleton instance of the console class.
+		 * @return 	basic_console& singleton instance of the console class.
+		 */
+		static basic_console& get_instance() {
+			static basic_console instance;
+			return instance;
+		}
+
+		/**
+		 * 	@brief 		Method start starts the child thread that prints queued messages, if it isn't running.
+		 * 	@note		The thread is started automatically the first time a message is queued, so this is only 
+		 * 				needed to move the cost of starting it out of the first print_parallel call. No thread 
+		 * 				is started when messages are drained by an external event loop, or in single threaded 
+		 * 				builds.
+		 */
+		void start() {
+#ifndef LOGGING_SINGLE_THREADED
+			std::scoped_lock<threading::mutex> lifecycle_lock(lifecycle_mutex);
+			if (!print_thread.joinable() && !external_drain) {
+				interrupt_flag.store(false);
+				print_thread = std::thread(&basic_console::empty_print_queue, this);
+				print_thread_running.store(true);
+				sink->set_flushed_later(true);
+			}
+#endif
+		}
+
+		/**
+		 * 	@brief 		Method stop stops the child thread, once it has printed every queued message.
+		 * 	@note		The thread is started again the next time a message is queued.
+		 */
+		void stop() {
+			std::scoped_lock<threading::mutex> lifecycle_lock(lifecycle_mutex);
+			if (print_thread.joinable()) {
+				{
+					std::scoped_lock<LockPolicy> print_queue_lock(print_queue_mutex);
+					interrupt_flag.store(true);
+				}
+				print_queue_condition_variable.notify_one();
+				print_thread.join();
+				print_thread_running.store(false);
+				sink->set_flushed_later(threading::SINGLE_THREADED);
+			}
+
+			// Print anything queued while the thread was stopping, including counts of suppressed exceptions.
+			std::pmr::vector<record> records(record_resource);
+			std::scoped_lock<threading::mutex> print_records_lock(print_records_mutex);
+			{
+				std::scoped_lock<LockPolicy> print_queue_lock(print_queue_mutex);
+				take_shards();
+				std::swap(records, print_queue);
+				prepare_storage(print_queue);
+			}
+			release_space(space_condition_variable);
+			gather_buffer output(record_resource);
+			if (prefault_memory) {
+				output.prefault(OUTPUT_BUFFER_SIZE, MAX_WRITE_VECTORS);
+			}
+			std::vector<std::string_view> segments;
+			std::deque<record> summaries;
+			print_records(records, output, segments, summaries, true);
+		}
+
+		/**
+		 * 	@brief 		Method configure applies settings to the console, stopping its child thread first.
+		 * 	@param 		configuration 	config settings to apply.
+		 * 	@note		This must not be called while other threads are printing.
+		 */
+		void configure(const config& configuration) {
+			stop();
+			std::scoped_lock<threading::mutex> lifecycle_lock(lifecycle_mutex);
+			std::pmr::memory_resource* resource = configuration.memory_resource;
+			size_t region_size = configuration.huge_page_bytes;
+			if (region_size == 0 && configuration.prefault_memory) {
+				// Fit the queue and the storage it swaps with, a long name and message for each record, the pool of 
+				// chunks and the output buffers, so that a steady load never allocates past the region.
+				region_size = std::max(configuration.queue_capacity, Capacity) * (3 * sizeof(record) + 2 * PREFAULT_MESSAGE_SIZE) + 
+					chunk_pool::MAX_FREE_CHUNKS * sizeof(chunk) + 3 * (OUTPUT_BUFFER_SIZE + MAX_WRITE_VECTORS * sizeof(iovec));
+			}
+			if (region_size > 0 && (resource == nullptr || configuration.prefault_memory)) {
+				// The huge pages are only mapped once, as records may still be allocated from them. Blocks that 
+				// don't fit are allocated from the memory resource, and counted as growth.
+				if (!own_huge_pages) {
+					own_huge_pages = std::make_unique<huge_page_resource>(region_size, resource != nullptr ? resource : record_resource);
+				}
+				resource = own_huge_pages.get();
+			}
+			if (resource != nullptr && resource != record_resource) {
+				record_resource = resource;
+				record_chunks.set_resource(record_resource);
+				reconstruct(print_queue, record_resource);
+				reconstruct(drain_records, record_resource);
+				reconstruct(drain_output, record_resource);
+			}
+			// A bounded queue always keeps space for its capacity.
+			queue_capacity = std::max(configuration.queue_capacity, Capacity);
+			prefault_memory = configuration.prefault_memory;
+			lock_memory = configuration.lock_memory;
+			prepare_storage(print_queue);
+			on_fork = configuration.on_fork;
+			child_output_descriptor = configuration.child_output_descriptor;
+			print_thread_config = configuration.print_thread;
+			external_drain = configuration.external_drain;
+			if (external_drain) {
+				open_event_descriptor();
+			}
+
+			// Construct each node's shard on that node, so its storage is placed there.
+			shards.clear();
+			if (configuration.numa_shards) {
+				shards.resize(get_node_count());
+				for (unsigned int node = 0; node < shards.size(); node++) {
+					run_on_node(node, [&] {
+						shards[node] = std::make_unique<queue_shard>(record_resource, queue_capacity);
+					});
+				}
+			}
+			if (prefault_memory) {
+				prefault_storage();
+			}
+
+			if (configuration.max_name_length > 0) {
+				*layout_max_name = configuration.max_name_length;
+			}
+
+			// Detect whether the new sink is a terminal once, as is done for stdout.
+			std::scoped_lock<threading::mutex> sink_lock(sink->mutex);
+			sink->set_descriptor(configuration.output_descriptor);
+		}
+
+		/**
+		 * 	@brief 		Method drain prints queued messages from the calling thread, for programs that print from 
+		 * 				their own event loop rather than a child thread. An example usage is included below.
+		 * 	@details	Messages are printed in batches until the queue is empty or either limit is reached. The 
+		 * 				event descriptor is left readable if messages are still queued, so the loop calls drain 
+		 * 				again. Counts of suppressed exceptions and the status line are only updated when drain is 
+		 * 				called, so the loop should also call it periodically, e.g. every 100ms.
+		 * 	@param 		max_records 	size_t maximum number of messages to print.
+		 * 	@param 		max_time 		std::chrono::nanoseconds maximum time to spend printing, checked between 
+		 * 								batches.
+		 * 	@return 	size_t number of messages printed.
+		 * 	@code {.cpp}
+		 * 	logging::config configuration;
+		 * 	configuration.external_drain = true;
+		 * 	logging::init(configuration);
+		 * 	epoll_event event{EPOLLIN, {}};
+		 * 	epoll_ctl(epoll, EPOLL_CTL_ADD, logging::console::get_instance().get_event_descriptor(), &event);
+		 * 	// When the descriptor is readable,
+		 * 	logging::console::get_instance().drain(1000, std::chrono::microseconds(500));
+		 * 	@endcode
+		 */
+		size_t drain(
+			size_t max_records = SIZE_MAX, 
+			std::chrono::nanoseconds max_time = std::chrono::nanoseconds::max()) 
+		{
+			auto start = std::chrono::steady_clock::now();
+			clear_event();
+			std::scoped_lock<threading::mutex> print_records_lock(print_records_mutex);
+			size_t printed = 0;
+			size_t taken = 0;
+			bool pending = false;
+			do {
+				{
+					// Take the next batch from the front of the queue, or the whole queue if it fits.
+					std::scoped_lock<LockPolicy> print_queue_lock(print_queue_mutex);
+					take_shards();
+					taken = std::min({print_queue.size(), max_records - printed, DRAIN_BATCH_SIZE});
+					if (taken == print_queue.size()) {
+						std::swap(drain_records, print_queue);
+					}
+					else {
+						std::move(print_queue.begin(), print_queue.begin() + taken, std::back_inserter(drain_records));
+						print_queue.erase(print_queue.begin(), print_queue.begin() + taken);
+					}
+					pending = !print_queue.empty();
+				}
+				release_space(space_condition_variable);
+				print_records(drain_records, drain_output, drain_segments, drain_summaries);
+				printed += taken;
+			} while (pending && printed < max_records && std::chrono::steady_clock::now() - start < max_time);
+			redraw_status();
+			if (pending) {
+				signal_event();
+			}
+			return printed;
+		}
+
+		/**
+		 * 	@brief 	Method get_event_descriptor gets the file descriptor that is readable while messages are 
+		 * 			queued for drain.
+		 * 	@return int file descriptor to poll for reading, or -1 if the console isn't configured to be drained 
+		 * 			externally, or on Windows.
+		 * 	@note	A forked child gets its own descriptor, so a child's loop must get it again after fork.
+		 */
+		int get_event_descriptor() const {
+			return event_descriptor;
+		}
+
+		/// Deleted cloning constructor.
+		basic_console(basic_console &other) = delete;
+		/// Deleted assignment operator.
+		void operator=(const basic_console &) = delete;
+
+		/**
+		 * 	@brief 		Method print_parallel sends the provided message to a child thread to
+		 * 				print as a formatted message to the console.
+		 * 	@details	The class tracks the messages that have been sent previously along 
+		 * 				with the current size of the console, to print messages into columns
+		 * 				along with splitting multi-line messages accordingly. The output 
+		 * 				follows the format:
+		 * 				| [SEVERITY] (NAME) MESSAGE LINE 1				|
+		 * 				|					LONGER MESSAGE LINE 2 		|
+		 * 				|					EVEN LONGER MESSAGE LINE 2	|
+		 * 				| [SEVERITY] (NAME) MESSAGE LINE 1				|
+		 * 	@param 		message 	string message to print to the console.
+		 * 	@param 		name 		string name of the component printing the message.
+		 * 	@param 		severity	logging::severity of the message.
+		 * 	@note		messages can contain newline characters ('\n') to print the message 
+		 * 				over separate lines.
+		 * 	@note		This method has significantly less overhead than the print method (by 
+		 * 				around 30x), and thus should be preferred for real-time use. The method 
+		 * 				works by adding the message to a queue where a child thread can service 
+		 * 				each print, thus blocking for a shorter period. An example usage is 
+		 * 				included below.
+		 * 	@code {.cpp}
+		 * 	logging::console::get_instance().print_parallel(
+		 * 		"Hello World!", 
+		 * 		"Example", 
+		 * 		logging::severity::info
+		 * 	)
+		 * 	@endcode
+		 * 	@note		The message and name are copied into the console's memory resource, see 
+		 * 				set_memory_resource.
+		 * 
+		 */
+		void print_parallel(
+			std::string_view message, 
+			std::string_view name,
+			const severity severity = severity::error) 
+		{
+			push_record(record{std::pmr::string(message, record_resource), std::pmr::string(name, record_resource), severity});
+		}
+
+		/**
+		 * 	@brief 		Method print_parallel sends a shared message to a child thread to print as a 
+		 * 				formatted message to the console, without copying it.
+		 * 	@details	Ownership of the message is passed through the print queue, so the child 
+		 * 				thread formats the message straight from the producer's buffer and releases 
+		 * 				it once it has been written. This should be preferred for large messages, like 
+		 * 				diagnostic dumps. An example usage is included below.
+		 * 	@param 		message 	shared pointer to the string message to print to the console.
+		 * 	@param 		name 		string name of the component printing the message.
+		 * 	@param 		severity	logging::severity of the message.
+		 * 	@note		The message must not be modified after it has been passed to this method.
+		 * 	@code {.cpp}
+		 * 	auto dump = std::make_shared<const std::string>(generate_dump());
+		 * 	logging::console::get_instance().print_parallel(
+		 * 		std::move(dump), 
+		 * 		"Example", 
+		 * 		logging::severity::info
+		 * 	)
+		 * 	@endcode
+		 */
+		void print_parallel(
+			std::shared_ptr<const std::string> message, 
+			std::string_view name,
+			const severity severity = severity::error) 
+		{
+			push_record(record{std::move(message), std::pmr::string(name, record_resource), severity});
+		}
+
+		/// Forward declaration of the class for writing a message to the console in pieces.
+		class record_writer;
+
+		/**
+		 * 	@brief 		Method begin_record starts a message that is written to the console in pieces, 
+		 * 				then sent to the child thread to print as a formatted message when it is committed.
+		 * 	@details	The pieces are copied into pooled fixed-size chunks as they are written, so very 
+		 * 				large messages never need to be built in one contiguous string. Lines of the 
+		 * 				message can be split across pieces. An example usage is included below.
+		 * 	@param 		name 		string name of the component printing the message.
+		 * 	@param 		severity	logging::severity of the message.
+		 * 	@return 	record_writer to write the message with.
+		 * 	@note		The message is discarded if the writer is destroyed without being committed.
+		 * 	@code {.cpp}
+		 * 	auto writer = logging::console::get_instance().begin_record("Example", logging::severity::info);
+		 * 	for (const auto& item : items) {
+		 * 		writer.write(serialise(item)).write("\n");
+		 * 	}
+		 * 	writer.commit();
+		 * 	@endcode
+		 */
+		record_writer begin_record(std::string_view name, const severity severity = severity::error);
+
+		/**
+		 * 	@brief 		Method print_parallel_batch sends a batch of messages to the child thread to print 
+		 * 				as formatted messages to the console, in one operation.
+		 * 	@details	Space for the whole batch is reserved in the print queue at once and the child 
+		 * 				thread is only woken once. The batch is printed contiguously, without messages 
+		 * 				from other threads in between. An example usage is included below.
+		 * 	@param 		messages 	container of string messages to print to the console, e.g. a 
+		 * 							std::vector<std::string> or std::array<std::string_view, N>.
+		 * 	@param 		name 		string name of the component printing the messages.
+		 * 	@param 		severity	logging::severity of the messages.
+		 * 	@code {.cpp}
+		 * 	std::vector<std::string> lines = dump_state();
+		 * 	logging::console::get_instance().print_parallel_batch(
+		 * 		lines, 
+		 * 		"Example", 
+		 * 		logging::severity::info
+		 * 	)
+		 * 	@endcode
+		 */
+		template <typename Messages>
+		void print_parallel_batch(
+			const Messages& messages, 
+			std::string_view name,
+			const severity severity = severity::error) 
+		{
+			// Copy the messages into records before taking the lock, in storage from the console's memory resource, 
+			// which is prefaulted and reused by its pools if the console prefaults its memory.
+			std::pmr::vector<record> batch(record_resource);
+			batch.reserve(std::size(messages));
+			for (const auto& message : messages) {
+				batch.push_back(record{std::pmr::string(message, record_resource), std::pmr::string(name, record_resource), severity});
+			}
+			if (!batch.empty()) {
+				// Follow the whole batch with one stack trace.
+				capture_frames(batch.back());
+			}
+
+			// Reserve space for the whole batch in the print queue and move it in. A batch larger than a bounded 
+			// queue is moved in as space is made for it, so only then can other messages come between its parts.
+			if (!threading::SINGLE_THREADED && !print_thread_running.load(std::memory_order_acquire) && !external_drain) {
+				start();
+			}
+			size_t queued = 0;
+			while (queued < batch.size()) {
+				queued += queue_records(batch.data() + queued, batch.size() - queued);
+				print_if_single_threaded();
+				if constexpr (std::is_same_v<OverflowPolicy, overflow::drop>) {
+					// The rest of the batch has been counted as dropped.
+					break;
+				}
+			}
+		}
+
+		/**
+		 * 	@brief 	Method flush_sink writes any output this console has buffered because its sink is not a terminal.
+		 */
+		void flush_sink() {
+			sink->flush();
+		}
+
+		/**
+		 * 	@brief 	Method get_memory_resource gets the memory resource the console allocates from.
+		 * 	@return	std::pmr::memory_resource* resource used by the console.
+		 */
+		std::pmr::memory_resource* get_memory_resource() const {
+			return record_resource;
+		}
+
+		/**
+		 * 	@brief 	Method get_dropped_count gets the number of messages dropped because the print queue was full.
+		 * 	@return	uint64_t number of messages dropped since the console was constructed, which is always 0 unless 
+		 * 			the console uses overflow::drop.
+		 */
+		uint64_t get_dropped_count() const {
+			return dropped_records.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * 	@brief 	Method get_memory_growth gets the number of times the console allocated more storage once it 
+		 * 			was running, which stays 0 in steady state if the storage was sized well.
+		 * 	@details	This counts the print queue or the output buffers growing past their reserved capacity, 
+		 * 				chunks allocated because the pool of chunks was empty, and blocks allocated past the end 
+		 * 				of the console's prefaulted region, e.g. for long messages.
+		 * 	@return	uint64_t number of times the storage grew, which is only counted with config::prefault_memory.
+		 */
+		uint64_t get_memory_growth() const {
+			if (!prefault_memory) {
+				return 0;
+			}
+			uint64_t growth = storage_growth.load(std::memory_order_relaxed) + record_chunks.get_miss_count() - prefill_misses;
+			if (const huge_page_resource* huge_pages = dynamic_cast<const huge_page_resource*>(record_resource)) {
+				growth += huge_pages->get_overflow_count() - prefill_overflows;
+			}
+			return growth;
+		}
+
+		/*************************************************************************************************/
+		/* Static Methods																				 */
+		/*************************************************************************************************/
+		/**
+		 * 	@brief 		Method enable_exception_logging logs every exception formatted by 
+		 * 				exception::format_message or created as an exception::error to the console.
+		 * 	@details	The throwing thread counts the exception against its throw site and type, and only 
+		 * 				queues it if fewer than limit have been queued from the site in the current window. 
+		 * 				The rest are counted without being copied, and the child thread prints how many were 
+		 * 				suppressed once the window has passed. An example usage is included below.
+		 * 	@param 		window 	std::chrono::milliseconds window that repeats from the same site are counted over.
+		 * 	@param 		limit 	unsigned int number of exceptions from the same site to print per window.
+		 * 	@code {.cpp}
+		 * 	logging::console::enable_exception_logging(std::chrono::seconds(5));
+		 * 	@endcode
+		 */
+		static void enable_exception_logging(
+			std::chrono::milliseconds window = std::chrono::seconds(1), 
+			unsigned int limit = 1) 
+		{
+			exception_window.store(window.count());
+			exception_limit.store(limit);
+			exception::set_exception_hook(&basic_console::log_exception);
+		}
+
+		/**
+		 * 	@brief 	Method disable_exception_logging stops logging exceptions to the console, which is the default.
+		 */
+		static void disable_exception_logging() {
+			exception::exception_hook expected = &basic_console::log_exception;
+			exception::installed_exception_hook.compare_exchange_strong(expected, nullptr);
+		}
+
+		/**
+		 * 	@brief 		Method set_status pins a status line below the log output.
+		 * 	@details	Messages printed while the status line is shown are inserted above it. The console 
+		 * 				thread redraws the status line as progress is made, at most at the status refresh 
+		 * 				rate, so any number of progress updates between redraws are coalesced into one. An 
+		 * 				example usage is included below.
+		 * 	@param 		text 	string text of the status line.
+		 * 	@param 		total 	uint64_t total amount of progress to show a progress bar for, or 0 for no bar.
+		 * 	@note		The status line is only shown when stdout is a terminal.
+		 * 	@code {.cpp}
+		 * 	logging::console::set_status("Processing", items.size());
+		 * 	for (size_t i = 0; i < items.size(); i++) {
+		 * 		process(items[i]);
+		 * 		logging::console::set_progress(i + 1);
+		 * 	}
+		 * 	logging::console::clear_status();
+		 * 	@endcode
+		 */
+		static void set_status(const std::string text, uint64_t total = 0) {
+			// If stdout is not a terminal, there is nowhere to pin the status line.
+			if (!standard_output.is_terminal()) {
+				return;
+			}
+
+			{
+				std::scoped_lock<threading::mutex> status_lock(status_mutex);
+				status_text = text;
+				status_total.store(total, std::memory_order_relaxed);
+				status_progress.store(0, std::memory_order_relaxed);
+				status_version.fetch_add(1, std::memory_order_relaxed);
+			}
+			status_active.store(true);
+
+			// Make sure the console thread is running to draw the status line.
+			get_instance().start();
+		}
+
+	protected:
+		/**
+		 * 	@brief	Struct chunk is a fixed-size block of a message written in pieces with a record_writer.
+		 */
+		struct chunk {
+			/// Number of bytes of message that fit in a chunk, so a chunk fills an allocation of RecordSize bytes.
+			const static inline size_t CAPACITY = RecordSize - sizeof(size_t);
+			/// Number of bytes of message in the chunk.
+			size_t length = 0;
+			/// Bytes of message in the chunk.
+			char data[CAPACITY];
+		};
+
+		/// Forward declaration of the pool that chunks are taken from.
+		class chunk_pool;
+
+		/**
+		 * 	@brief	Struct chunk_releaser is the deleter for chunks, which returns them to their pool.
+		 */
+		struct chunk_releaser {
+			/// Pool the chunk was taken from.
+			chunk_pool* pool;
+			/// Memory resource the chunk was allocated from.
+			std::pmr::memory_resource* resource;
+
+			/**
+			 * 	@brief	Operator () returns a chunk to its pool.
+			 * 	@param	released 	chunk* chunk to return.
+			 */
+			void operator()(chunk* released) const {
+				pool->release(released, resource);
+			}
+		};
+
+		/// Owning pointer to a chunk, which returns it to its pool when destroyed.
+		using chunk_pointer = std::unique_ptr<chunk, chunk_releaser>;
+
+		/**
+		 * 	@class	chunk_pool
+		 * 	@brief	Class chunk_pool keeps chunks that have been released for reuse, so writing messages in 
+		 * 			pieces doesn't allocate in steady state.
+		 */
+		class chunk_pool {
+		public:
+			/**
+			 * 	@brief	Constructor for the chunk_pool class.
+			 * 	@param	resource 	std::pmr::memory_resource* resource to allocate chunks from.
+			 */
+			explicit chunk_pool(std::pmr::memory_resource* resource) :
+				resource(resource),
+				free_chunks(resource)
+			{
+				free_chunks.reserve(MAX_FREE_CHUNKS);
+			}
+
+			/// Destructor for the chunk_pool class, which frees the chunks left in the pool.
+			~chunk_pool() {
+				for (chunk* free_chunk : free_chunks) {
+					deallocate(free_chunk, resource);
+				}
+			}
+
+			/// Deleted cloning constructor.
+			chunk_pool(const chunk_pool&) = delete;
+			/// Deleted assignment operator.
+			void operator=(const chunk_pool&) = delete;
+
+			/**
+			 * 	@brief	Method acquire takes an empty chunk from the pool, allocating one if the pool is empty.
+			 * 	@return	chunk_pointer empty chunk.
+			 */
+			chunk_pointer acquire() {
+				chunk* acquired = nullptr;
+				std::pmr::memory_resource* acquired_resource;
+				{
+					std::scoped_lock<threading::mutex> lock(mutex);
+					acquired_resource = resource;
+					if (!free_chunks.empty()) {
+						acquired = free_chunks.back();
+						free_chunks.pop_back();
+					}
+				}
+				if (acquired == nullptr) {
+					misses.fetch_add(1, std::memory_order_relaxed);
+					acquired = new (acquired_resource->allocate(sizeof(chunk), alignof(chunk))) chunk;
+				}
+				acquired->length = 0;
+				return chunk_pointer(acquired, chunk_releaser{this, acquired_resource});
+			}
+
+			/**
+			 * 	@brief	Method release returns a chunk to the pool, or frees it if the pool is full or the chunk 
+			 * 			is from a different memory resource.
+			 * 	@param	released 			chunk* chunk to return.
+			 * 	@param	released_resource 	std::pmr::memory_resource* resource the chunk was allocated from.
+			 */
+			void release(chunk* released, std::pmr::memory_resource* released_resource) {
+				{
+					std::scoped_lock<threading::mutex> lock(mutex);
+					if (released_resource == resource && free_chunks.size() < MAX_FREE_CHUNKS) {
+						free_chunks.push_back(released);
+						return;
+					}
+				}
+				deallocate(released, released_resource);
+			}
+
+			/**
+			 * 	@brief	Method set_resource frees the chunks in the pool and allocates new chunks from another 
+			 * 			memory resource.
+			 * 	@param	new_resource 	std::pmr::memory_resource* resource to allocate chunks from.
+			 * 	@note	Chunks still in use are freed to the resource they were allocated from.
+			 */
+			void set_resource(std::pmr::memory_resource* new_resource) {
+				std::scoped_lock<threading::mutex> lock(mutex);
+				for (chunk* free_chunk : free_chunks) {
+					deallocate(free_chunk, resource);
+				}
+				resource = new_resource;
+				reconstruct(free_chunks, new_resource);
+				free_chunks.reserve(MAX_FREE_CHUNKS);
+			}
+
+			/**
+			 * 	@brief	Method prefill fills the pool with chunks and touches them, so writing messages in pieces 
+			 * 			doesn't allocate or take page faults until more chunks are in use at once than it holds.
+			 * 	@param	filled 	function called with the start and size of each chunk added, e.g. to lock it.
+			 */
+			template <typename Function>
+			void prefill(Function&& filled) {
+				std::scoped_lock<threading::mutex> lock(mutex);
+				while (free_chunks.size() < MAX_FREE_CHUNKS) {
+					chunk* added = new (resource->allocate(sizeof(chunk), alignof(chunk))) chunk;
+					std::memset(added->data, 0, sizeof(added->data));
+					filled(static_cast<void*>(added), sizeof(chunk));
+					free_chunks.push_back(added);
+				}
+			}
+
+			/**
+			 * 	@brief	Method get_miss_count gets the number of chunks allocated because the pool was empty.
+			 * 	@return	uint64_t number of chunks allocated.
+			 */
+			uint64_t get_miss_count() const {
+				return misses.load(std::memory_order_relaxed);
+			}
+
+			/// Method lock locks the pool, so it is left consistent by fork.
+			void lock() {
+				mutex.lock();
+			}
+
+			/// Method unlock unlocks the pool after fork.
+			void unlock() {
+				mutex.unlock();
+			}
+
+			/// Maximum number of chunks kept in the pool.
+			const static inline size_t MAX_FREE_CHUNKS = 64;
+
+		private:
+			/// Memory resource the chunks are allocated from.
+			std::pmr::memory_resource* resource;
+			/// Mutex to protect access to the free chunks.
+			threading::mutex mutex;
+			/// Chunks available for reuse.
+			std::pmr::vector<chunk*> free_chunks;
+			/// Number of chunks allocated because the pool was empty.
+			threading::atomic<uint64_t> misses{0};
+
+			/**
+			 * 	@brief	Static method deallocate returns a chunk's memory to a memory resource.
+			 * 	@param	freed 			chunk* chunk to free.
+			 * 	@param	freed_resource 	std::pmr::memory_resource* resource the chunk was allocated from.
+			 */
+			static void deallocate(chunk* freed, std::pmr::memory_resource* freed_resource) {
+				freed->~chunk();
+				freed_resource->deallocate(freed, sizeof(chunk), alignof(chunk));
+			}
+		};
+
+		/**
+		 * 	@brief	Struct record holds a message waiting in the print queue.
+		 */
+		struct record {
+			/// Message to print, either owned by the record, shared with the producer, or written in chunks.
+			std::variant<std::pmr::string, std::shared_ptr<const std::string>, std::pmr::vector<chunk_pointer>> message;
+			/// Name of the component printing the message.
+			std::pmr::string name;
+			/// Severity of the message.
+			logging::severity severity;
+			/// Return addresses of the stack trace captured with the message, if any.
+			std::pmr::vector<void*> frames{};
+			/// Site the message was thrown from if it is a logged exception, or an unknown site otherwise.
+			exception::throw_site site{};
+
+			/**
+			 * 	@brief	Method get_segments gets views of the segments of the message, wherever it is stored.
+			 * 	@param	segments 	vector of string views to add the segments of the message to.
+			 */
+			void get_segments(std::vector<std::string_view>& segments) const {
+				if (const auto* chunks = std::get_if<std::pmr::vector<chunk_pointer>>(&message)) {
+					for (const chunk_pointer& chunk : *chunks) {
+						segments.emplace_back(chunk->data, chunk->length);
+					}
+				}
+				else if (const auto* shared_message = std::get_if<std::shared_ptr<const std::string>>(&message)) {
+					if (*shared_message) {
+						segments.emplace_back(**shared_message);
+					}
+				}
+				else {
+					segments.emplace_back(std::get<std::pmr::string>(message));
+				}
+
+				// Follow the message with its stack trace, naming each frame as it is printed.
+				for (void* frame : frames) {
+					segments.emplace_back(stack_trace::FRAME_PREFIX);
+					segments.emplace_back(stack_trace::get_symbol(frame));
+				}
+			}
+		};
+
+		/// Condition variable type that waits with the lock policy, which is the cheaper std::condition_variable 
+		/// for std::mutex.
+		using queue_condition_variable = std::conditional_t<std::is_same_v<LockPolicy, std::mutex>, 
+			std::condition_variable, std::condition_variable_any>;
+
+		/**
+		 * 	@brief	Struct queue_shard is the shard of the print queue for one NUMA node, which is constructed on that 
+		 * 			node so its memory is too.
+		 * 	@details	The print thread swaps the queued messages with the spare storage rather than its own, so the 
+		 * 				shard's storage never leaves its node. Shards are aligned to cache lines so producers on 
+		 * 				different nodes never share one.
+		 */
+		struct alignas(64) queue_shard {
+			/// Mutex to protect access to the messages, of the type chosen by the lock policy.
+			LockPolicy mutex;
+			/// Messages queued by producers on the node.
+			std::pmr::vector<record> records;
+			/// Storage the print thread swaps with the queued messages, then prints them from.
+			std::pmr::vector<record> spare;
+			/// Condition variable to indicate to blocked producers when the print thread has taken the messages.
+			queue_condition_variable space;
+
+			/**
+			 * 	@brief	Constructor for the queue_shard class, which touches the storage it reserves so its pages are 
+			 * 			placed on the node of the calling thread.
+			 * 	@param	resource 	std::pmr::memory_resource* resource to allocate the storage from.
+			 * 	@param	capacity 	size_t number of messages to reserve space for.
+			 */
+			queue_shard(std::pmr::memory_resource* resource, size_t capacity) :
+				records(resource),
+				spare(resource)
+			{
+				records.resize(capacity);
+				records.clear();
+				spare.resize(capacity);
+				spare.clear();
+			}
+		};
+
+		/*************************************************************************************************/
+		/* Non-Static Members																			 */
+		/*************************************************************************************************/
+		/// Flag to interrupt the singleton child threads. 
+		threading::atomic<bool> interrupt_flag;
+		/// Flag for if the printing child thread is running.
+		threading::atomic<bool> print_thread_running;
+		/// Sink owned by an independent console, or nullptr for the singleton, which writes to stdout.
+		std::unique_ptr<output_sink> own_sink;
+		/// Sink the console writes to.
+		output_sink* sink;
+		/// Maximum name width seen so far by an independent console.
+		unsigned int own_max_name_width;
+		/// Maximum name width the console lays messages out with, which the singleton shares with print.
+		unsigned int* layout_max_name;
+		/// Huge pages the console maps for its records, which must outlive everything allocated from them.
+		std::unique_ptr<huge_page_resource> own_huge_pages;
+		/// Memory resource queued messages, message chunks and formatted output are allocated from.
+		std::pmr::memory_resource* record_resource;
+		/// Pool of chunks for messages written in pieces, which must outlive the print queue.
+		chunk_pool record_chunks;
+		/// Queue of messages to be serviced by the printing child thread.
+		std::pmr::vector<record> print_queue;
+		/// Number of messages space is reserved for in the print queue.
+		size_t queue_capacity;
+		/// Printing child thread which will service the print queue.
+		std::thread print_thread;
+		/// Mutex to protect starting, stopping and configuring the printing child thread.
+		threading::mutex lifecycle_mutex;
+		/// Mutex to protect access to the print queue, of the type chosen by the lock policy.
+		LockPolicy print_queue_mutex;
+		/// Mutex held while messages taken from the print queue are printed, so fork can wait for them.
+		threading::mutex print_records_mutex;
+		/// Condition variable to indicate to the print thread when there are messages to print.
+		queue_condition_variable print_queue_condition_variable;
+		/// Condition variable to indicate to blocked producers when the print thread has taken the queue.
+		queue_condition_variable space_condition_variable;
+		/// Number of messages dropped because the print queue was full.
+		threading::atomic<uint64_t> dropped_records;
+		/// Number of dropped messages that have been reported, used by the print thread.
+		uint64_t dropped_reported;
+		/// Shards of the print queue for each NUMA node, or empty if messages are queued in the print queue.
+		std::vector<std::unique_ptr<queue_shard>> shards;
+		/// Flag for if messages have been queued in a shard since the print thread last took them.
+		bool shards_pending;
+		/// Version of the status text last drawn by the print thread.
+		unsigned int status_drawn_version;
+		/// Progress last drawn by the print thread.
+		uint64_t status_drawn_progress;
+		/// Time the status line was last drawn by the print thread.
+		std::chrono::steady_clock::time_point status_drawn_time;
+		/// Line of the message being laid out by the print thread, or by stop once the thread has stopped.
+		line_view record_line;
+		/// Exceptions admitted and suppressed for each throw site, found by the hash of the site.
+		std::array<exception_site_state, EXCEPTION_SITES> exception_sites;
+		/// What a child process does with the messages queued when it was forked.
+		fork_policy on_fork;
+		/// File descriptor a child process writes to after it is forked, or -1 to keep the same sink.
+		int child_output_descriptor;
+		/// Settings the printing child thread applies to itself when it starts.
+		thread_config print_thread_config;
+		/// Flag for if queued messages are printed by drain from an external event loop, instead of a child thread.
+		bool external_drain;
+		/// Descriptor that is readable while messages are queued for drain, or -1 if it isn't open.
+		int event_descriptor;
+		/// Descriptor written to signal the event descriptor, which is the same descriptor on Linux.
+		int event_write_descriptor;
+		/// Messages being printed by drain.
+		std::pmr::vector<record> drain_records;
+		/// Formatted output for the messages being printed by drain.
+		gather_buffer drain_output;
+		/// Segments of the message being formatted by drain.
+		std::vector<std::string_view> drain_segments;
+		/// Messages counting suppressed exceptions printed by drain.
+		std::deque<record> drain_summaries;
+		/// Flag for if the console's storage is touched when it is allocated, and checked for growth.
+		bool prefault_memory;
+		/// Flag for if the console's storage is locked into memory when it is allocated.
+		bool lock_memory;
+		/// Flag for if locking the console's storage has failed, so the warning is only printed once.
+		bool lock_failed;
+		/// Number of times the print queue or an output buffer grew past its reserved capacity once prefaulted.
+		threading::atomic<uint64_t> storage_growth;
+		/// Number of times the console's storage had grown when growth was last reported, used by the print thread.
+		uint64_t growth_reported;
+		/// Number of chunks the chunk pool had allocated when it was prefilled.
+		uint64_t prefill_misses;
+		/// Number of blocks the huge pages had allocated upstream when the console was prefaulted.
+		uint64_t prefill_overflows;
+
+		/*************************************************************************************************/
+		/* Non-Static Methods																			 */
+		/*************************************************************************************************/
+		/**
+		 * @brief Protected constructor for the console singleton, which leaves the child thread to be started when 
+		 * 		  it is first needed.
+		 */
+		basic_console() :
+			basic_console(nullptr)
+		{}
+
+		/**
+		 * @brief Protected constructor for the console class.
+		 * @param sink 	std::unique_ptr<output_sink> sink owned by an independent console, or nullptr for the 
+		 * 				singleton, which writes to stdout.
+		 */
+		explicit basic_console(std::unique_ptr<output_sink> sink) :
+			interrupt_flag(false),
+			print_thread_running(false),
+			own_sink(std::move(sink)),
+			sink(own_sink ? own_sink.get() : &standard_output),
+			own_max_name_width(DEFAULT_NAME_WIDTH),
+			layout_max_name(own_sink ? &own_max_name_width : &max_name_width),
+			record_resource(initial_memory_resource.load() != nullptr && !own_sink ? 
+				initial_memory_resource.load() : std::pmr::get_default_resource()),
+			record_chunks(record_resource),
+			print_queue(record_resource),
+			queue_capacity(Capacity),
+			dropped_records(0),
+			dropped_reported(0),
+			shards_pending(false),
+			status_drawn_version(0),
+			status_drawn_progress(0),
+			status_drawn_time{},
+			on_fork(fork_policy::discard),
+			child_output_descriptor(-1),
+			print_thread_config{},
+			external_drain(false),
+			event_descriptor(-1),
+			event_write_descriptor(-1),
+			drain_records(record_resource),
+			drain_output(record_resource),
+			prefault_memory(false),
+			lock_memory(false),
+			lock_failed(false),
+			storage_growth(0),
+			growth_reported(0),
+			prefill_misses(0),
+			prefill_overflows(0)
+		{
+			// Reserve the whole of a bounded queue up front, so it never allocates once the console is running.
+			print_queue.reserve(queue_capacity);
+			link_instance();
+			// Without a print thread, the console flushes its buffered output when it is destroyed.
+			if (threading::SINGLE_THREADED) {
+				this->sink->set_flushed_later(true);
+			}
+		}
+
+	public:
+		/**
+		 * @brief 		Constructor for an independent console, with its own queue, child thread, sink and name 
+		 * 				column, configured before it prints anything. An example usage is included below.
+		 * @details		Heavy subsystems can log through their own console so they don't contend with the rest of 
+		 * 				the program on the singleton's queue, and can be configured independently. 
+		 * @param 		configuration 	config settings of the console, including the descriptor it writes to.
+		 * @note		Only the singleton logs exceptions and draws the status line. Consoles writing to the same 
+		 * 				descriptor write whole batches of messages at a time, but their columns aren't aligned.
+		 * @code {.cpp}
+		 * logging::config configuration;
+		 * configuration.output_descriptor = open("orders.log", O_WRONLY | O_CREAT | O_APPEND, 0644);
+		 * logging::console orders(configuration);
+		 * orders.print_parallel("Order filled.", "Orders", logging::severity::info);
+		 * @endcode
+		 */
+		explicit basic_console(const config& configuration) :
+			basic_console(std::make_unique<output_sink>(configuration.output_descriptor))
+		{
+			configure(configuration);
+		}
+
+		/**
+		 * @brief Destructor for the console class which stops the child thread.
+		 */
+		~basic_console()
+		{
+			unlink_instance();
+			bool is_singleton = !own_sink;
+			if (is_singleton) {
+				disable_exception_logging();
+			}
+			sink->set_flushed_later(false);
+			stop();
+			if (is_singleton) {
+				clear_status();
+			}
+			sink->flush();
+			close_event_descriptor();
+		}
+
+	protected:
+
+		/**
+		 *	@brief	Method empty_print_queue runs in it's own thread, where it waits on the print queue 
+		 *			condition variable for messages then prints them to the console.
+		 */
+		void empty_print_queue() {
+			apply_thread_config();
+
+			// Messages taken from the print queue, which swaps storage with the queue so neither reallocates.
+			std::pmr::vector<record> records(record_resource);
+			prepare_storage(records);
+			// Formatted output for the messages taken from the print queue.
+			gather_buffer output(record_resource);
+			if (prefault_memory) {
+				output.prefault(OUTPUT_BUFFER_SIZE, MAX_WRITE_VECTORS);
+			}
+			// Segments of the message being formatted.
+			std::vector<std::string_view> segments;
+			// Messages counting suppressed exceptions, which must stay in place until they have been written.
+			std::deque<record> summaries;
+
+			// While the thread has not been interrupted,
+			while(!interrupt_flag.load()) {
+				{
+					// Wait on the print queue empty condition variable for a fixed duration,
+					std::unique_lock<LockPolicy> print_queue_lock(print_queue_mutex);
+					while (print_queue.empty() && !shards_pending && !interrupt_flag.load()) {
+						// Wake up in time to redraw the status line if one is shown.
+						auto timeout = WAIT_TIMEOUT_MS;
+						if (status_active.load()) {
+							timeout = std::min(timeout, get_status_refresh_interval());
+						}
+						if (print_queue_condition_variable.wait_for(print_queue_lock, timeout) == std::cv_status::timeout) {
+							// While idle, flush any output left in the buffer and redraw the status line without 
+							// blocking the producers.
+							print_queue_lock.unlock();
+							sink->flush();
+							redraw_status();
+							print_queue_lock.lock();
+
+							// Stop waiting if there are suppressed exceptions that may need to be counted.
+							if (has_suppressed_exceptions()) {
+								break;
+							}
+						}
+					}
+				}
+
+				{
+					// Take all of the messages in the queue at once, holding the print lock first so that a fork 
+					// never happens between taking messages and printing them.
+					std::scoped_lock<threading::mutex> print_records_lock(print_records_mutex);
+					{
+						std::scoped_lock<LockPolicy> print_queue_lock(print_queue_mutex);
+						take_shards();
+						std::swap(records, print_queue);
+					}
+					release_space(space_condition_variable);
+					print_records(records, output, segments, summaries);
+				}
+				redraw_status();
+			}
+		}
+
+		/**
+		 *	@brief	Method get_wrap_width gets the width the console's sink wraps lines at.
+		 *	@return	unsigned int width in characters of stdout's terminal, if the sink is stdout or another 
+		 *			terminal, or else 0 so lines written to a pipe or file are never wrapped.
+		 */
+		unsigned int get_wrap_width() const {
+			if (sink == &standard_output || sink->is_terminal()) {
+				return load_console_width();
+			}
+			return 0;
+		}
+
+		/**
+		 *	@brief	Method print_records formats messages taken from the print queue and prints them together, so 
+		 *			batches stay contiguous.
+		 *	@param	records 		vector of records to print, which is emptied once they have been written.
+		 *	@param	output 			gather_buffer to lay the messages out in.
+		 *	@param	segments 		vector of string views to hold the segments of each message.
+		 *	@param	summaries 		deque of records to hold the counts of suppressed exceptions.
+		 *	@param	expire_all 		bool true to count the suppressed exceptions of every site, as when stopping.
+		 */
+		void print_records(
+			std::pmr::vector<record>& records,
+			gather_buffer& output,
+			std::vector<std::string_view>& segments,
+			std::deque<record>& summaries,
+			bool expire_all = false) 
+		{
+			output.clear();
+			size_t reserved = output.capacity();
+			bool urgent = false;
+			auto now = std::chrono::steady_clock::now();
+			for (const record& record : records) {
+				urgent |= record.severity >= severity::error;
+				// Remember the name and severity exceptions from the site are reported with.
+				if (record.site.file != nullptr) {
+					if (exception_site_state* state = find_exception_site(record.site, false)) {
+						state->name.assign(record.name);
+						state->severity = record.severity;
+					}
+				}
+				segments.clear();
+				record.get_segments(segments);
+				layout(segments.data(), segments.size(), record.name, record.severity, ClockPolicy::now(), output, record_line, *layout_max_name, sink->is_colour(), get_wrap_width());
+			}
+			summarise_exceptions(now, summaries, output, expire_all);
+			if constexpr (std::is_same_v<OverflowPolicy, overflow::drop>) {
+				summarise_dropped(summaries, output);
+			}
+			if (prefault_memory) {
+				if (output.capacity() > reserved) {
+					storage_growth.fetch_add(1, std::memory_order_relaxed);
+				}
+				summarise_growth(summaries, output);
+			}
+			if (output.length() > 0) {
+				// Without a print thread, errors are written straight away so they aren't lost if the program 
+				// then crashes.
+				sink->write(output, threading::SINGLE_THREADED && urgent);
+			}
+
+			// Release the messages now that they have been written, including any shared buffers.
+			records.clear();
+			summaries.clear();
+		}
+
+		/**
+		 *	@brief	Static method log_exception queues an exception to be printed, and is installed as the 
+		 *			exception hook by enable_exception_logging.
+		 *	@param	site 		exception::throw_site of the exception.
+		 *	@param	message 	string message of the exception.
+		 *	@param	name 		string name of the component throwing the exception.
+		 *	@param	severity	logging::severity of the exception.
+		 */
+		static void log_exception(
+			const exception::throw_site& site, 
+			std::string_view message, 
+			std::string_view name, 
+			const severity severity) 
+		{
+			basic_console& instance = get_instance();
+			if (!instance.admit_exception(site)) {
+				return;
+			}
+			record logged{
+				std::pmr::string(message, instance.record_resource), 
+				std::pmr::string(name, instance.record_resource), 
+				severity
+			};
+			logged.site = site;
+			instance.push_record(std::move(logged));
+		}
+
+		/**
+		 *	@brief	Method find_exception_site finds the state counting the exceptions from a throw site.
+		 *	@param	site 	exception::throw_site to find.
+		 *	@param	claim 	bool true to claim a state for the site if it doesn't have one.
+		 *	@return	exception_site_state* state of the site, or nullptr if it has none and none could be claimed.
+		 */
+		exception_site_state* find_exception_site(const exception::throw_site& site, bool claim) {
+			size_t key = std::max<size_t>(throw_site_hash()(site), 1);
+			for (size_t probe = 0; probe < EXCEPTION_SITE_PROBES; probe++) {
+				exception_site_state& state = exception_sites[(key + probe) % EXCEPTION_SITES];
+				size_t current = state.key.load(std::memory_order_acquire);
+				if (current == 0 && claim && state.key.compare_exchange_strong(current, key)) {
+					state.file.store(site.file);
+					state.line.store(site.line);
+					return &state;
+				}
+				if (current == key) {
+					return &state;
+				}
+			}
+			return nullptr;
+		}
+
+		/**
+		 *	@brief	Method admit_exception counts an exception against its throw site on the throwing thread, and 
+		 *			checks if it should be queued.
+		 *	@param	site 	exception::throw_site of the exception.
+		 *	@return	bool true if the exception should be queued, false if it has been counted as suppressed.
+		 */
+		bool admit_exception(const exception::throw_site& site) {
+			exception_site_state* state = site.file != nullptr ? find_exception_site(site, true) : nullptr;
+			if (state == nullptr) {
+				return true;
+			}
+
+			// If the site's window has passed, start a new one, which only one thread does.
+			int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+			int64_t window = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::milliseconds(exception_window.load())).count();
+			int64_t window_start = state->window_start.load(std::memory_order_acquire);
+			if (window_start == 0 || now - window_start >= window) {
+				if (state->window_start.compare_exchange_strong(window_start, now)) {
+					state->admitted.store(0);
+				}
+			}
+
+			if (state->admitted.fetch_add(1) < exception_limit.load()) {
+				return true;
+			}
+			state->suppressed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		/**
+		 *	@brief	Method has_suppressed_exceptions checks if any throw site has suppressed exceptions to report.
+		 *	@return	bool true if a site has suppressed exceptions.
+		 */
+		bool has_suppressed_exceptions() const {
+			for (const exception_site_state& state : exception_sites) {
+				if (state.key.load(std::memory_order_relaxed) != 0 && state.suppressed.load(std::memory_order_relaxed) > 0) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 *	@brief	Method summarise_exceptions counts the suppressed exceptions of sites that haven't been reported 
+		 *			for a window.
+		 *	@param	now 		std::chrono::steady_clock::time_point current time.
+		 *	@param	summaries 	deque of records to add the counts of suppressed exceptions to.
+		 *	@param	output 		gather_buffer to lay the counts of suppressed exceptions out in.
+		 *	@param	expire_all 	bool true to count the suppressed exceptions of every site, whether or not a window 
+		 *						has passed.
+		 */
+		void summarise_exceptions(
+			std::chrono::steady_clock::time_point now, 
+			std::deque<record>& summaries,
+			gather_buffer& output,
+			bool expire_all = false) 
+		{
+			auto window = std::chrono::milliseconds(exception_window.load());
+			for (exception_site_state& state : exception_sites) {
+				if (state.key.load(std::memory_order_acquire) == 0 || state.suppressed.load(std::memory_order_relaxed) == 0) {
+					continue;
+				}
+				// Start counting a window from when the suppressed exceptions were first seen.
+				if (!expire_all && state.reported == std::chrono::steady_clock::time_point{}) {
+					state.reported = now;
+					continue;
+				}
+				if (!expire_all && now - state.reported < window) {
+					continue;
+				}
+				state.reported = now;
+				summarise_exception(state, state.suppressed.exchange(0), summaries, output);
+			}
+		}
+
+		/**
+		 *	@brief	Method summarise_exception lays out how many exceptions were suppressed at a throw site.
+		 *	@param	state 		exception_site_state of the site.
+		 *	@param	suppressed 	uint64_t number of exceptions suppressed.
+		 *	@param	summaries 	deque of records to add the count of suppressed exceptions to, so it stays in place 
+		 *						until it has been written.
+		 *	@param	output 		gather_buffer to lay the count out in.
+		 */
+		void summarise_exception(
+			const exception_site_state& state, 
+			uint64_t suppressed,
+			std::deque<record>& summaries,
+			gather_buffer& output) 
+		{
+			const char* file = state.file.load();
+			std::pmr::string summary(record_resource);
+			summary.append("Suppressed ");
+			summary.append(std::to_string(suppressed));
+			summary.append(suppressed == 1 ? " repeat" : " repeats");
+			summary.append(" of the exception thrown at ");
+			summary.append(file != nullptr ? file : "an unknown site");
+			summary.append(":");
+			summary.append(std::to_string(state.line.load()));
+			summary.append(".");
+			summaries.push_back(record{std::move(summary), std::pmr::string(state.name, record_resource), state.severity});
+
+			std::string_view message = std::get<std::pmr::string>(summaries.back().message);
+			layout(&message, 1, summaries.back().name, summaries.back().severity, ClockPolicy::now(), output, record_line, *layout_max_name, sink->is_colour(), get_wrap_width());
+		}
+
+		/**
+		 *	@brief	Method summarise_dropped lays out how many messages have been dropped since the last summary, if 
+		 *			any, because the print queue was full.
+		 *	@param	summaries 	deque of records to add the count of dropped messages to, so it stays in place until it 
+		 *						has been written.
+		 *	@param	output 		gather_buffer to lay the count out in.
+		 */
+		void summarise_dropped(std::deque<record>& summaries, gather_buffer& output) {
+			uint64_t dropped = dropped_records.load(std::memory_order_relaxed) - dropped_reported;
+			if (dropped == 0) {
+				return;
+			}
+			dropped_reported += dropped;
+
+			std::pmr::string summary(record_resource);
+			summary.append("Dropped ");
+			summary.append(std::to_string(dropped));
+			summary.append(dropped == 1 ? " message" : " messages");
+			summary.append(" because the print queue was full.");
+			summaries.push_back(record{std::move(summary), std::pmr::string("LogConsole", record_resource), severity::warning});
+
+			std::string_view message = std::get<std::pmr::string>(summaries.back().message);
+			layout(&message, 1, summaries.back().name, summaries.back().severity, ClockPolicy::now(), output, record_line, *layout_max_name, sink->is_colour(), get_wrap_width());
+		}
+
+		/**
+		 *	@brief	Method summarise_growth lays out how many times the console's storage has grown since the last 
+		 *			summary, if it has, as a prefaulted console should never allocate in steady state.
+		 *	@param	summaries 	deque of records to add the count to, so it stays in place until it has been written.
+		 *	@param	output 		gather_buffer to lay the count out in.
+		 */
+		void summarise_growth(std::deque<record>& summaries, gather_buffer& output) {
+			uint64_t growth = get_memory_growth();
+			if (growth <= growth_reported) {
+				return;
+			}
+			uint64_t grown = growth - growth_reported;
+			growth_reported = growth;
+
+			std::pmr::string summary(record_resource);
+			summary.append("Allocated more storage ");
+			summary.append(std::to_string(grown));
+			summary.append(grown == 1 ? " time" : " times");
+			summary.append(" after it was prefaulted, so queue_capacity or huge_page_bytes should be raised.");
+			summaries.push_back(record{std::move(summary), std::pmr::string("LogConsole", record_resource), severity::warning});
+
+			std::string_view message = std::get<std::pmr::string>(summaries.back().message);
+			layout(&message, 1, summaries.back().name, summaries.back().severity, ClockPolicy::now(), output, record_line, *layout_max_name, sink->is_colour(), get_wrap_width());
+		}
+
+		/**
+		 *	@brief	Method prepare_storage reserves space in a queue for its capacity, touching and locking it if the 
+		 *			console prefaults its memory.
+		 *	@param	storage 	vector of records to prepare.
+		 */
+		void prepare_storage(std::pmr::vector<record>& storage) {
+			storage.reserve(queue_capacity);
+			if (!prefault_memory) {
+				return;
+			}
+			storage.resize(storage.capacity());
+			storage.clear();
+			lock_storage(storage.data(), storage.capacity() * sizeof(record));
+		}
+
+		/**
+		 *	@brief	Method lock_storage locks a block of the console's storage into memory if the console locks its 
+		 *			memory, warning the first time it can't, e.g. because it is over the RLIMIT_MEMLOCK limit.
+		 *	@param	start 	const void* start of the block.
+		 *	@param	bytes 	size_t length of the block in bytes.
+		 */
+		void lock_storage(const void* start, size_t bytes) {
+			if (!lock_memory || lock_failed) {
+				return;
+			}
+			int error = lock_pages(start, bytes);
+			if (error != 0) {
+				lock_failed = true;
+				warn_lock_failed(error);
+			}
+		}
+
+		/**
+		 *	@brief	Method prefault_storage touches and optionally locks the storage the console allocates besides 
+		 *			the print queue, then takes the counts that growth is measured from.
+		 */
+		void prefault_storage() {
+			record_chunks.prefill([this](const void* start, size_t bytes) {
+				lock_storage(start, bytes);
+			});
+			prepare_storage(drain_records);
+			drain_output.prefault(OUTPUT_BUFFER_SIZE, MAX_WRITE_VECTORS);
+			for (std::unique_ptr<queue_shard>& shard : shards) {
+				lock_storage(shard->records.data(), shard->records.capacity() * sizeof(record));
+				lock_storage(shard->spare.data(), shard->spare.capacity() * sizeof(record));
+			}
+			huge_page_resource* huge_pages = dynamic_cast<huge_page_resource*>(record_resource);
+			if (huge_pages != nullptr && lock_memory && !lock_failed) {
+				int error = huge_pages->lock();
+				if (error != 0) {
+					lock_failed = true;
+					warn_lock_failed(error);
+				}
+			}
+			prefill_misses = record_chunks.get_miss_count();
+			prefill_overflows = huge_pages != nullptr ? huge_pages->get_overflow_count() : 0;
+		}
+
+		/**
+		 *	@brief	Method count_growth counts messages that will make a queue grow past its reserved capacity, once 
+		 *			the console is prefaulted.
+		 *	@param	queue 	vector of records the messages are being added to.
+		 *	@param	added 	size_t number of messages being added.
+		 *	@note	The queue's mutex must be held.
+		 */
+		void count_growth(const std::pmr::vector<record>& queue, size_t added) {
+			if (prefault_memory && queue.size() + added > queue.capacity()) {
+				storage_growth.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 *	@brief	Method capture_frames captures a stack trace for a record if traces are captured for its severity.
+		 *	@param	captured 	record to capture the stack trace for.
+		 */
+		void capture_frames(record& captured) {
+			if (stack_trace::should_capture(captured.severity)) {
+				std::array<void*, stack_trace::MAX_FRAMES> frames;
+				size_t frame_count = stack_trace::capture(frames.data(), frames.size(), 1);
+				captured.frames = std::pmr::vector<void*>(frames.begin(), frames.begin() + frame_count, record_resource);
+			}
+		}
+
+		/// Method lock_for_fork takes the locks of the console's queue and print thread, in order, before fork.
+		void lock_for_fork() override {
+			lifecycle_mutex.lock();
+			print_records_mutex.lock();
+			print_queue_mutex.lock();
+			for (std::unique_ptr<queue_shard>& shard : shards) {
+				shard->mutex.lock();
+			}
+		}
+
+		/// Method lock_storage_for_fork takes the locks of the console's own sink and chunk pool before fork.
+		void lock_storage_for_fork() override {
+			if (own_sink) {
+				own_sink->mutex.lock();
+			}
+			record_chunks.lock();
+		}
+
+		/// Method unlock_storage_after_fork releases the locks taken by lock_storage_for_fork.
+		void unlock_storage_after_fork() override {
+			record_chunks.unlock();
+			if (own_sink) {
+				own_sink->mutex.unlock();
+			}
+		}
+
+		/// Method unlock_after_fork releases the locks taken by lock_for_fork.
+		void unlock_after_fork() override {
+			for (auto shard = shards.rbegin(); shard != shards.rend(); ++shard) {
+				(*shard)->mutex.unlock();
+			}
+			print_queue_mutex.unlock();
+			print_records_mutex.unlock();
+			lifecycle_mutex.unlock();
+		}
+
+		/**
+		 *	@brief	Method reset_after_fork resets the console in a child process, keeping or dropping its queued 
+		 *			messages by its fork policy.
+		 *	@return	bool true if the console has queued messages to print.
+		 */
+		bool reset_after_fork() override {
+			// The parent's print thread doesn't exist in the child, so forget it rather than joining it, and 
+			// replace the condition variables it and the producers may have been waiting on.
+			new (&print_thread) std::thread();
+			new (&print_queue_condition_variable) queue_condition_variable();
+			new (&space_condition_variable) queue_condition_variable();
+			for (std::unique_ptr<queue_shard>& shard : shards) {
+				new (&shard->space) queue_condition_variable();
+			}
+			print_thread_running.store(false);
+			interrupt_flag.store(false);
+			sink->set_flushed_later(threading::SINGLE_THREADED);
+
+			if (on_fork == fork_policy::preserve) {
+				// This thread already holds the shards' locks, so take their messages without locking them again.
+				shards_pending = false;
+				for (std::unique_ptr<queue_shard>& shard : shards) {
+					std::move(shard->records.begin(), shard->records.end(), std::back_inserter(print_queue));
+					shard->records.clear();
+				}
+			}
+			for (exception_site_state& state : exception_sites) {
+				state.key.store(0);
+				state.window_start.store(0);
+				state.admitted.store(0);
+				state.suppressed.store(0);
+				state.reported = {};
+			}
+			sink->discard_buffer();
+			if (child_output_descriptor >= 0) {
+				sink->set_descriptor(child_output_descriptor);
+			}
+			if (external_drain) {
+				// The parent's event descriptor is shared with the child, so the child needs its own.
+				close_event_descriptor();
+				open_event_descriptor();
+			}
+			return on_fork == fork_policy::preserve && !print_queue.empty();
+		}
+
+		/// Method discard_after_fork drops the messages queued when the process was forked, by the fork policy.
+		void discard_after_fork() override {
+			if (on_fork != fork_policy::discard) {
+				return;
+			}
+			std::scoped_lock<LockPolicy> print_queue_lock(print_queue_mutex);
+			print_queue.clear();
+			for (std::unique_ptr<queue_shard>& shard : shards) {
+				std::scoped_lock<LockPolicy> shard_lock(shard->mutex);
+				shard->records.clear();
+			}
+		}
+
+		/// Method resume_after_fork starts printing the messages the console kept in a child process.
+		void resume_after_fork() override {
+			start();
+			signal_event();
+		}
+
+		/**
+		 *	@brief	Method apply_thread_config applies the thread settings to the calling thread, printing a 
+		 *			warning for each setting that can't be applied, e.g. a real-time policy without permission.
+		 */
+		void apply_thread_config() {
+#ifdef __linux__
+			const thread_config& settings = print_thread_config;
+			pthread_t self = pthread_self();
+			if (!settings.name.empty()) {
+				// Names longer than the limit are truncated rather than rejected.
+				std::string name = settings.name.substr(0, 15);
+				pthread_setname_np(self, name.c_str());
+			}
+			if (!settings.cpus.empty()) {
+				cpu_set_t cpus;
+				CPU_ZERO(&cpus);
+				for (unsigned int cpu : settings.cpus) {
+					if (cpu < CPU_SETSIZE) {
+						CPU_SET(cpu, &cpus);
+					}
+				}
+				int result = pthread_setaffinity_np(self, sizeof(cpus), &cpus);
+				if (result != 0) {
+					warn_thread_config("affinity", result);
+				}
+			}
+			if (settings.policy >= 0) {
+				sched_param parameters{};
+				parameters.sched_priority = settings.priority;
+				int result = pthread_setschedparam(self, settings.policy, &parameters);
+				if (result != 0) {
+					warn_thread_config("scheduling policy", result);
+				}
+			}
+			if (settings.nice != 0) {
+				// The nice value of a thread is set through its thread ID on Linux.
+				pid_t thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+				if (setpriority(PRIO_PROCESS, static_cast<id_t>(thread_id), settings.nice) != 0) {
+					warn_thread_config("nice value", errno);
+				}
+			}
+#endif
+		}
+
+		/**
+		 *	@brief	Method push_record adds a record to the print queue and wakes the print thread.
+		 *	@param	pushed 	record to add to the print queue.
+		 */
+		void push_record(record&& pushed) {
+			if (!threading::SINGLE_THREADED && !print_thread_running.load(std::memory_order_acquire) && !external_drain) {
+				start();
+			}
+			capture_frames(pushed);
+			if (queue_records(&pushed, 1) == 0) {
+				return;
+			}
+			print_if_single_threaded();
+		}
+
+		/**
+		 *	@brief	Method queue_records moves messages into the print queue, or into the shard of the calling 
+		 *			thread's NUMA node, and wakes the print thread.
+		 *	@details	A shard only wakes the print thread when it was empty, as the print thread takes every shard 
+		 *				each time it wakes, so producers on a node rarely touch the print queue's lock.
+		 *	@param	first 	record* first of the messages to move.
+		 *	@param	count 	size_t number of messages to move.
+		 *	@return	size_t number of the messages queued, which is less than count if the overflow policy limits it.
+		 */
+		size_t queue_records(record* first, size_t count) {
+			if (shards.empty()) {
+				std::unique_lock<LockPolicy> lock(print_queue_mutex);
+				size_t space = make_space(lock, print_queue, space_condition_variable, count);
+				bool was_empty = print_queue.empty();
+				count_growth(print_queue, space);
+				if (space > 1) {
+					print_queue.reserve(print_queue.size() + space);
+				}
+				std::move(first, first + space, std::back_inserter(print_queue));
+				wake_printer(was_empty);
+				return space;
+			}
+
+			queue_shard& shard = *shards[get_current_node() % shards.size()];
+			size_t space = 0;
+			bool was_empty = false;
+			{
+				std::unique_lock<LockPolicy> lock(shard.mutex);
+				space = make_space(lock, shard.records, shard.space, count);
+				was_empty = shard.records.empty();
+				count_growth(shard.records, space);
+				if (space > 1) {
+					shard.records.reserve(shard.records.size() + space);
+				}
+				std::move(first, first + space, std::back_inserter(shard.records));
+			}
+			if (was_empty && space > 0) {
+				if (external_drain) {
+					signal_event();
+				}
+				else if (!threading::SINGLE_THREADED) {
+					std::scoped_lock<LockPolicy> print_queue_lock(print_queue_mutex);
+					shards_pending = true;
+					print_queue_condition_variable.notify_one();
+				}
+			}
+			return space;
+		}
+
+		/**
+		 *	@brief	Method take_shards moves the messages queued in each shard to the end of the print queue.
+		 *	@details	Each shard's messages are swapped out with its spare storage, so the shard's storage stays on 
+		 *				its node, and only the records are moved. The messages of different nodes are not ordered 
+		 *				with respect to each other, only with the other messages from the same node. As the shards 
+		 *				are always taken in node order, a producer that migrates from a higher node to a lower one 
+		 *				between messages can have its messages printed out of order.
+		 *	@note	The print queue mutex must be held, and is always taken before a shard's mutex.
+		 */
+		void take_shards() {
+			shards_pending = false;
+			for (std::unique_ptr<queue_shard>& shard : shards) {
+				{
+					std::scoped_lock<LockPolicy> shard_lock(shard->mutex);
+					std::swap(shard->records, shard->spare);
+				}
+				release_space(shard->space);
+				std::move(shard->spare.begin(), shard->spare.end(), std::back_inserter(print_queue));
+				shard->spare.clear();
+			}
+		}
+
+		/**
+		 *	@brief	Method make_space makes space in the print queue for messages by the overflow policy, which is 
+		 *			resolved at compile time.
+		 *	@details	A queue that grows always has space. When a bounded queue is full, overflow::block waits for 
+		 *				the print thread to take the queue, and overflow::drop counts the messages that don't fit.
+		 *	@param	lock 	std::unique_lock of the queue's mutex, which is released while waiting.
+		 *	@param	queue 	vector of records to make space in, the print queue or a shard.
+		 *	@param	space 	condition variable notified when the queue's messages are taken.
+		 *	@param	wanted 	size_t number of messages to queue.
+		 *	@return	size_t number of the messages that may be queued, which for overflow::block is at least one.
+		 */
+		size_t make_space(
+			[[maybe_unused]] std::unique_lock<LockPolicy>& lock, 
+			[[maybe_unused]] const std::pmr::vector<record>& queue,
+			[[maybe_unused]] queue_condition_variable& space,
+			size_t wanted) 
+		{
+			if constexpr (std::is_same_v<OverflowPolicy, overflow::grow>) {
+				return wanted;
+			}
+			else if constexpr (std::is_same_v<OverflowPolicy, overflow::block>) {
+				while (queue.size() >= Capacity) {
+					space.wait(lock);
+				}
+				return std::min(wanted, Capacity - queue.size());
+			}
+			else {
+				size_t space_left = Capacity - std::min(queue.size(), Capacity);
+				if (space_left < wanted) {
+					dropped_records.fetch_add(wanted - space_left, std::memory_order_relaxed);
+				}
+				return std::min(wanted, space_left);
+			}
+		}
+
+		/**
+		 *	@brief	Method release_space wakes the producers blocked by a full queue, once messages have been taken 
+		 *			from it.
+		 *	@param	space 	condition variable of the print queue or shard the messages were taken from.
+		 */
+		void release_space([[maybe_unused]] queue_condition_variable& space) {
+			if constexpr (std::is_same_v<OverflowPolicy, overflow::block>) {
+				space.notify_all();
+			}
+		}
+
+		/**
+		 *	@brief	Method print_if_single_threaded prints the queue from the calling thread in single threaded 
+		 *			builds, where there is no print thread, unless it is drained by an external event loop.
+		 *	@details	The output is still collected in the output buffer when stdout isn't a terminal, and is 
+		 *				written once the buffer fills, once it is older than OUTPUT_FLUSH_INTERVAL when more is 
+		 *				printed, when an error is printed, when print writes after it, or when the console is 
+		 *				flushed or destroyed.
+		 */
+		void print_if_single_threaded() {
+			if (threading::SINGLE_THREADED && !external_drain) {
+				drain();
+			}
+		}
+
+		/**
+		 *	@brief	Method wake_printer wakes the print thread once messages have been queued, or signals the event 
+		 *			descriptor if the queue was empty and it is drained externally.
+		 *	@param	was_empty 	bool true if the print queue was empty before the messages were queued.
+		 *	@note	The print queue mutex must be held.
+		 */
+		void wake_printer(bool was_empty) {
+			if (external_drain) {
+				// The descriptor stays readable until drained, so it only needs signalling once.
+				if (was_empty) {
+					signal_event();
+				}
+			}
+			else if (!threading::SINGLE_THREADED) {
+				print_queue_condition_variable.notify_one();
+			}
+		}
+
+		/**
+		 *	@brief	Method open_event_descriptor opens the descriptor signalled when messages are queued, if it 
+		 *			isn't already open.
+		 */
+		void open_event_descriptor() {
+#ifndef _WIN32
+			if (event_descriptor >= 0) {
+				return;
+			}
+#ifdef __linux__
+			event_descriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			event_write_descriptor = event_descriptor;
+#else
+			int descriptors[2];
+			if (pipe(descriptors) == 0) {
+				for (int descriptor : descriptors) {
+					fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+					fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+				}
+				event_descriptor = descriptors[0];
+				event_write_descriptor = descriptors[1];
+			}
+#endif
+#endif
+		}
+
+		/**
+		 *	@brief	Method close_event_descriptor closes the descriptor signalled when messages are queued.
+		 */
+		void close_event_descriptor() {
+#ifndef _WIN32
+			if (event_write_descriptor >= 0 && event_write_descriptor != event_descriptor) {
+				close(event_write_descriptor);
+			}
+			if (event_descriptor >= 0) {
+				close(event_descriptor);
+			}
+#endif
+			event_descriptor = -1;
+			event_write_descriptor = -1;
+		}
+
+		/**
+		 *	@brief	Method signal_event makes the event descriptor readable.
+		 */
+		void signal_event() {
+#ifndef _WIN32
+			if (event_write_descriptor >= 0) {
+				// A full counter or pipe is already readable, so failing to write is harmless.
+				uint64_t count = 1;
+				[[maybe_unused]] ssize_t written = write(event_write_descriptor, &count, 
+					event_write_descriptor == event_descriptor ? sizeof(count) : 1);
+			}
+#endif
+		}
+
+		/**
+		 *	@brief	Method clear_event reads the event descriptor until it is no longer readable.
+		 */
+		void clear_event() {
+#ifndef _WIN32
+			if (event_descriptor >= 0) {
+				uint64_t count[8];
+				while (read(event_descriptor, count, sizeof(count)) > 0) {}
+			}
+#endif
+		}
+
+		/**
+		 *	@brief	Method redraw_status redraws the status line if it has changed, at most at the status refresh 
+		 *			rate.
+		 */
+		void redraw_status() {
+			// Only the console printing to stdout draws the status line.
+			if (!status_active.load() || sink != &standard_output) {
+				return;
+			}
+
+			// If the status line was drawn too recently, or hasn't changed, leave it.
+			auto now = std::chrono::steady_clock::now();
+			unsigned int version = status_version.load(std::memory_order_relaxed);
+			uint64_t progress = status_progress.load(std::memory_order_relaxed);
+			if (now - status_drawn_time < get_status_refresh_interval() ||
+				(version == status_drawn_version && progress == status_drawn_progress)) {
+				return;
+			}
+
+			// Build the status line from the text and progress.
+			std::string line;
+			{
+				std::scoped_lock<threading::mutex> status_lock(status_mutex);
+				line = status_text;
+			}
+			uint64_t total = status_total.load(std::memory_order_relaxed);
+			if (total > 0) {
+				// Draw a progress bar in the format: TEXT [=====>    ]  50% (5/10)
+				progress = std::min(progress, total);
+				size_t filled = static_cast<size_t>(STATUS_BAR_WIDTH * progress / total);
+				line += " [" + std::string(filled, '=');
+				if (filled < STATUS_BAR_WIDTH) {
+					line += ">" + std::string(STATUS_BAR_WIDTH - filled - 1, ' ');
+				}
+				std::string percent = std::to_string(100 * progress / total);
+				line += "] " + std::string(3 - std::min<size_t>(percent.length(), 3), ' ') + percent + "% (" +
+					std::to_string(progress) + "/" + std::to_string(total) + ")";
+			}
+			else if (progress > 0) {
+				line += " (" + std::to_string(progress) + ")";
+			}
+
+			// Keep the status line on one line so it can be redrawn in place.
+			unsigned int width = load_console_width();
+			if (width > 0 && line.length() >= width) {
+				line.resize(width - 1);
+			}
+
+			{
+				// Lock the standard output mutex.
+				std::scoped_lock<threading::mutex> std_out_lock(standard_output.mutex);
+
+				// If the status line was cleared while it was being built, don't draw it.
+				if (!status_active.load()) {
+					return;
+				}
+
+				// Replace the status line on the console.
+				status_line = line;
+				standard_output.write_direct(ERASE_LINE);
+				standard_output.write_direct(status_line);
+			}
+
+			status_drawn_time = now;
+			status_drawn_version = version;
+			status_drawn_progress = progress;
+		}
+	};
+
+	/**
+	 * 	@anchor		console
+	 * 	@brief 		Type console is the basic_console with the default policies: a print queue that grows to fit, 
+	 * 				timestamps from std::chrono::system_clock and a mutex protecting the queue.
+	 */
+	using console = basic_console<>;
+
+	/**
+	 * 	@anchor		record_writer
+	 * 	@class 		basic_console::record_writer
+	 * 	@brief 		Class record_writer writes a message to the console in pieces, started with 
+	 * 				console::begin_record.
+	 * 	@details	Each piece is copied into pooled fixed-size chunks, and the chunks are passed 
+	 * 				through the print queue when the message is committed, so the message is never 
+	 * 				held in one contiguous string.
+	 */
+	template <size_t Capacity, size_t RecordSize, typename OverflowPolicy, typename ClockPolicy, typename LockPolicy>
+	class basic_console<Capacity, RecordSize, OverflowPolicy, ClockPolicy, LockPolicy>::record_writer {
+	public:
+		/**
+		 * 	@brief 	Constructor for the record_writer class.
+		 * 	@param 	owner 		basic_console& console the message will be printed by.
+		 * 	@param 	name 		string name of the component printing the message.
+		 * 	@param 	severity	logging::severity of the message.
+		 */
+		record_writer(basic_console& owner, std::string_view name, const logging::severity severity) :
+			owner(&owner),
+			name(name, owner.record_resource),
+			severity(severity),
+			chunks(owner.record_resource)
+		{}
+
+		/// Move constructor, leaving the other writer unable to commit.
+		record_writer(record_writer&& other) noexcept :
+			owner(std::exchange(other.owner, nullptr)),
+			name(std::move(other.name)),
+			severity(other.severity),
+			chunks(std::move(other.chunks))
+		{}
+
+		/// Deleted cloning constructor.
+		record_writer(const record_writer&) = delete;
+		/// Deleted assignment operator.
+		void operator=(const record_writer&) = delete;
+
+		/**
+		 * 	@brief 	Method write appends a piece to the message.
+		 * 	@param 	piece 	string piece of the message, which may contain or split lines.
+		 * 	@return record_writer& this writer, so writes can be chained.
+		 * 	@note	Writing to a writer that has been committed or moved from does nothing, as it has no message.
+		 */
+		record_writer& write(std::string_view piece) {
+			if (owner == nullptr) {
+				return *this;
+			}
+			while (!piece.empty()) {
+				// If the last chunk is full, take another from the pool.
+				if (chunks.empty() || chunks.back()->length == chunk::CAPACITY) {
+					chunks.push_back(owner->record_chunks.acquire());
+				}
+
+				// Copy as much of the piece as fits into the last chunk.
+				chunk& last = *chunks.back();
+				size_t length = std::min(piece.length(), chunk::CAPACITY - last.length);
+				std::copy_n(piece.data(), length, last.data + last.length);
+				last.length += length;
+				piece.remove_prefix(length);
+			}
+			return *this;
+		}
+
+		/**
+		 * 	@brief 	Method commit sends the message to the console's child thread to print.
+		 * 	@note	Nothing more can be written once the message has been committed.
+		 */
+		void commit() {
+			if (owner != nullptr) {
+				std::exchange(owner, nullptr)->push_record(record{std::move(chunks), std::move(name), severity});
+			}
+		}
+
+	private:
+		/// Console the message will be printed by, or nullptr once committed.
+		basic_console* owner;
+		/// Name of the component printing the message.
+		std::pmr::string name;
+		/// Severity of the message.
+		logging::severity severity;
+		/// Chunks the message has been written to so far, allocated from the console's memory resource.
+		std::pmr::vector<chunk_pointer> chunks;
+	};
+
+	template <size_t Capacity, size_t RecordSize, typename OverflowPolicy, typename ClockPolicy, typename LockPolicy>
+	inline typename basic_console<Capacity, RecordSize, OverflowPolicy, ClockPolicy, LockPolicy>::record_writer 
+	basic_console<Capacity, RecordSize, OverflowPolicy, ClockPolicy, LockPolicy>::begin_record(
+		std::string_view name, 
+		const logging::severity severity) 
+	{
+		return record_writer(*this, name, severity);
+	}
+
+	/**
+	 * 	@brief 		Function init configures logging before it is used.
+	 * 	@details	The console's child thread is not started by this function. It is started the first time a 
+	 * 				message is queued, so programs that only print synchronously never start it. Logging can 
+	 * 				be initialised again after shutdown, with different settings. An example usage is included 
+	 * 				below.
+	 * 	@param 		configuration 	config settings to apply.
+	 * 	@note		This must not be called while other threads are logging.
+	 * 	@code {.cpp}
+	 * 	logging::config configuration;
+	 * 	configuration.queue_capacity = 1024;
+	 * 	logging::init(configuration);
+	 * 	@endcode
+	 */
+	inline void init(const config& configuration = {}) {
+		console::get_instance().configure(configuration);
+	}
+
+	/**
+	 * 	@brief 		Function shutdown prints every queued message, flushes the output and stops the console's 
+	 * 				child thread.
+	 * 	@note		Messages queued after this are still printed, by starting the thread again.
+	 */
+	inline void shutdown() {
+		console::get_instance().stop();
+		console::flush();
+	}
 }
 #endif /* LOG_CONSOLE_HPP */
\ No newline at end of file
@@ -10,17 +10,252 @@
 #define LOG_EXCEPTION_HPP
 
 // System Libraries
-#include <deque>
-#include <iostream>
-#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <typeinfo>
 
 // Log Base Header
 #include "LogBase.hpp"
+// Log Stack Trace Header
+#include "LogStackTrace.hpp"
 
 namespace logging {
 	namespace exception {
+		/**
+		 * 	@brief	Struct throw_site identifies where an exception was formatted, and its type if known.
+		 */
+		struct throw_site {
+			/// Name of the source file, or nullptr if the site is unknown.
+			const char* file = nullptr;
+			/// Line in the source file.
+			unsigned int line = 0;
+			/// Type of the exception, or nullptr if it is unknown.
+			const std::type_info* type = nullptr;
+
+			/**
+			 * 	@brief	Static method current gets the site this method is called from, which is the caller's site 
+			 * 			when it is used as a default argument.
+			 * 	@param	type 	const std::type_info* type of the exception, or nullptr if it is unknown.
+			 * 	@param	file 	const char* name of the source file, which should be left as the default.
+			 * 	@param	line 	unsigned int line in the source file, which should be left as the default.
+			 * 	@return	throw_site site of the caller.
+			 */
+			static constexpr throw_site current(
+				const std::type_info* type = nullptr,
+				const char* file = __builtin_FILE(), 
+				unsigned int line = __builtin_LINE()) noexcept 
+			{
+				return throw_site{file, line, type};
+			}
+
+			/// Equality operator, which compares the names of the files rather than where they are stored, as 
+			/// each translation unit may have its own copy of a name.
+			bool operator==(const throw_site& other) const noexcept {
+				if (line != other.line || (file == nullptr) != (other.file == nullptr)) {
+					return false;
+				}
+				if ((type == nullptr) != (other.type == nullptr) || (type != nullptr && *type != *other.type)) {
+					return false;
+				}
+				return file == other.file || std::string_view(file) == std::string_view(other.file);
+			}
+		};
+
+		/**
+		 * 	@brief	Type exception_hook is a function called with each exception formatted by format_message or 
+		 * 			created as an error, e.g. to log it.
+		 * 	@note	The hook is called on the throwing thread, so it should only do a small amount of work.
+		 */
+		using exception_hook = void (*)(const throw_site& site, std::string_view message, std::string_view name, severity severity);
+
+		/// Hook called with each exception, or nullptr if none is installed.
+		inline threading::atomic<exception_hook> installed_exception_hook{nullptr};
+
+		/**
+		 * 	@brief 	Function set_exception_hook installs a hook called with each exception formatted by 
+		 * 			format_message or created as an error, e.g. console::enable_exception_logging.
+		 * 	@param 	hook 	exception_hook function to call, or nullptr to remove the hook.
+		 */
+		inline void set_exception_hook(exception_hook hook) {
+			installed_exception_hook.store(hook);
+		}
+
+		/**
+		 * 	@brief 	Function notify_exception_hook calls the installed hook with an exception, if there is one.
+		 * 	@param 	site 		throw_site of the exception.
+		 * 	@param 	message 	string message of the exception.
+		 * 	@param 	name 		string name of the component throwing the exception.
+		 * 	@param 	severity	logging::severity of the exception.
+		 */
+		inline void notify_exception_hook(const throw_site& site, std::string_view message, std::string_view name, severity severity) {
+			if (exception_hook hook = installed_exception_hook.load(std::memory_order_relaxed)) {
+				hook(site, message, name, severity);
+			}
+		}
+
+		/**
+		 * 	@brief 		Function layout_message writes a formatted message to an output.
+		 * 	@details	The output is anything with append(std::string_view) and pad(size_t) methods, such 
+		 * 				as a format_buffer. The message is written in the format returned by format_message.
+		 * 	@param 		message 	string message to include in the output.
+		 * 	@param 		name 		string name of the component formatting the message.
+		 * 	@param 		severity	logging::severity of the message.
+		 * 	@param 		time 		std::chrono::system_clock::time_point time of the message.
+		 * 	@param 		output 		output to write the formatted message to.
+		 */
+		template <typename Output>
+		static void layout_message(
+			std::string_view message, 
+			std::string_view name,
+			severity severity,
+			std::chrono::system_clock::time_point time,
+			Output& output) 
+		{
+			// Generate the timestamp for the message.
+			char timestamp[time_template_width];
+			size_t timestamp_length = write_timestamp(timestamp, time);
+			std::string_view severity_name = Severity(severity).to_string_view();
+
+			// Print the first line of the output in the format:
+			// [TIME] [SEVERITY] (NAME) MESSAGE LINE 1
+			size_t time_width = std::max<size_t>(timestamp_length + 1, time_template_width);
+			size_t severity_width = std::max<size_t>(severity_name.length() + 1, Severity::get_max_severity_length() + 2);
+			output.append("[");
+			output.append(std::string_view(timestamp, timestamp_length));
+			output.append("]");
+			output.pad(time_width - timestamp_length - 1);
+			output.append("[");
+			output.append(severity_name);
+			output.append("]");
+			output.pad(severity_width - severity_name.length() - 1);
+			output.append("(");
+			output.append(name);
+			output.append(") ");
+
+			// Get the width of the preamble printed before the first line.
+			size_t preamble_width = 1 + time_width + 1 + severity_width + 1 + name.length() + 2;
+
+			// For each line of the message (there is guaranteed to be 1),
+			size_t line_start = 0;
+			while (true) {
+				size_t line_end = message.find('\n', line_start);
+
+				// Write the line to the output right aligned with the rest of the lines.
+				if (line_start > 0) {
+					output.pad(preamble_width);
+				}
+				output.append(message.substr(line_start, line_end - line_start));
+				output.append("\n");
+
+				if (line_end == std::string_view::npos) {
+					break;
+				}
+				line_start = line_end + 1;
+			}
+		}
+
+		/// Marker ending messages that were truncated to fit a buffer.
+		const static inline std::string_view TRUNCATION_MARKER = "...\n";
+		/// Size of the stack buffer format_message tries to format a message into before allocating.
+		const static inline size_t FORMAT_STACK_BUFFER_SIZE = 512;
+
+		/**
+		 * 	@brief 		Function format_message_to formats a message into a buffer provided by the caller, 
+		 * 				without allocating.
+		 * 	@details	The message is formatted in the same way as format_message. If it doesn't fit, as 
+		 * 				much as fits is written and the end of the buffer is overwritten with 
+		 * 				TRUNCATION_MARKER. An example usage is included below.
+		 * 	@param 		buffer 		char* buffer to format the message into, which may be nullptr if 
+		 * 							capacity is 0.
+		 * 	@param 		capacity 	size_t size of the buffer in bytes.
+		 * 	@param 		message 	string message to include in the buffer.
+		 * 	@param 		name 		string name of the component formatting the message.
+		 * 	@param 		severity	logging::severity of the message.
+		 * 	@param 		time 		std::chrono::system_clock::time_point time of the message.
+		 * 	@return 	size_t length of the whole formatted message, which is greater than capacity if it 
+		 * 				was truncated.
+		 * 	@note		The buffer is not null terminated.
+		 * 	@code {.cpp}
+		 * 	char buffer[256];
+		 * 	size_t length = logging::exception::format_message_to(buffer, sizeof(buffer), "Overrun.", "Example");
+		 * 	write(STDERR_FILENO, buffer, std::min(length, sizeof(buffer)));
+		 * 	@endcode
+		 */
+		inline size_t format_message_to(
+			char* buffer,
+			size_t capacity,
+			std::string_view message, 
+			std::string_view name,
+			severity severity = severity::error,
+			std::chrono::system_clock::time_point time = std::chrono::system_clock::now()) noexcept
+		{
+			bounded_buffer output(buffer, capacity);
+			layout_message(message, name, severity, time, output);
+			output.mark_truncation(TRUNCATION_MARKER);
+			return output.length();
+		}
+
+		/**
+		 * 	@brief 		Function format_message_to formats a message through an output iterator.
+		 * 	@details	The message is formatted in the same way as format_message, e.g. into a 
+		 * 				std::back_inserter of a container the caller has reserved.
+		 * 	@param 		output 		OutputIterator iterator of char to write the formatted message to.
+		 * 	@param 		message 	string message to include in the output.
+		 * 	@param 		name 		string name of the component formatting the message.
+		 * 	@param 		severity	logging::severity of the message.
+		 * 	@return 	OutputIterator iterator past the end of the formatted message.
+		 */
+		template <typename OutputIterator>
+		OutputIterator format_message_to(
+			OutputIterator output,
+			std::string_view message, 
+			std::string_view name,
+			severity severity = severity::error)
+		{
+			iterator_buffer<OutputIterator> iterator_output(output);
+			layout_message(message, name, severity, std::chrono::system_clock::now(), iterator_output);
+			return iterator_output.get_iterator();
+		}
+
+		/**
+		 * 	@brief 		Function format_message_as formats a message into a string of any type.
+		 * 	@details	The message is formatted on the stack, then copied into the string, so the only 
+		 * 				allocation is the string itself. Messages too long for the stack buffer are formatted 
+		 * 				again straight into the string.
+		 * 	@param 		formatted 	string to assign the formatted message to.
+		 * 	@param 		message 	string message to include in the string.
+		 * 	@param 		name 		string name of the component formatting the message.
+		 * 	@param 		severity	logging::severity of the message.
+		 * 	@param 		time 		std::chrono::system_clock::time_point time of the message.
+		 */
+		template <typename String>
+		static void format_message_as(
+			String& formatted,
+			std::string_view message, 
+			std::string_view name,
+			severity severity,
+			std::chrono::system_clock::time_point time) 
+		{
+			char buffer[FORMAT_STACK_BUFFER_SIZE];
+			size_t length = format_message_to(buffer, sizeof(buffer), message, name, severity, time);
+			if (length <= sizeof(buffer)) {
+				formatted.assign(buffer, length);
+			}
+			else {
+				formatted.resize(length);
+				format_message_to(formatted.data(), length, message, name, severity, time);
+			}
+		}
+
 		/**
 		 * 	@brief 		Function format_message returns a formatted string with the message.
 		 * 	@details	Formats the message with the sender and severity into columns
@@ -33,53 +268,248 @@ namespace logging {
 		 * 	@param 		message 	string message to include in the string.
 		 * 	@param 		name 		string name of the component formatting the message.
 		 * 	@param 		severity	logging::severity of the message.
+		 * 	@param 		site 		throw_site the message is formatted at, which should be left as the default.
 		 * 	@return 	std::string formatted string.
 		 * 	@note		messages can contain newline characters ('\n') to include the message 
 		 * 				over separate lines.
+		 * 	@note		This is a wrapper around format_message_to, so the only allocation is the returned string.
+		 * 	@note		The message is passed to the exception hook, if one is installed.
 		 */
 		const static std::string format_message(
-			std::string message, 
-			std::string name,
-			severity severity = severity::error) 
+			std::string_view message, 
+			std::string_view name,
+			severity severity = severity::error,
+			const throw_site& site = throw_site::current()) 
 		{
-			// Generate the timestamp for the message.
-			std::string timestamp = generate_timestamp();
+			notify_exception_hook(site, message, name, severity);
+			std::string formatted;
+			format_message_as(formatted, message, name, severity, std::chrono::system_clock::now());
+			return formatted;
+		}
 
-			// Split the message into a queue of lines.
-			std::deque<std::string> message_lines = logging::split_string(message, "\n");
+		/**
+		 * 	@brief 		Function format_message returns a formatted string with the message, allocated from 
+		 * 				a memory resource.
+		 * 	@param 		resource 	std::pmr::memory_resource* resource to allocate the returned string from.
+		 * 	@param 		message 	string message to include in the string.
+		 * 	@param 		name 		string name of the component formatting the message.
+		 * 	@param 		severity	logging::severity of the message.
+		 * 	@param 		site 		throw_site the message is formatted at, which should be left as the default.
+		 * 	@return 	std::pmr::string formatted string, using the resource.
+		 * 	@note		The format is the same as the std::string overload of format_message.
+		 */
+		static std::pmr::string format_message(
+			std::pmr::memory_resource* resource,
+			std::string_view message, 
+			std::string_view name,
+			severity severity = severity::error,
+			const throw_site& site = throw_site::current()) 
+		{
+			notify_exception_hook(site, message, name, severity);
+			std::pmr::string formatted(resource);
+			format_message_as(formatted, message, name, severity, std::chrono::system_clock::now());
+			return formatted;
+		}
 
-			// Create a string stream to write the formatted output string to.
-			std::stringstream ss;
+		/**
+		 * 	@class		error
+		 * 	@brief 		Class error is an exception with a message that is formatted like format_message, but 
+		 * 				only when what() is first called.
+		 * 	@details	The time, severity, name and message are captured when the exception is created, so 
+		 * 				exceptions that are caught and handled without reading the message never pay for 
+		 * 				formatting. The formatted message is cached and shared between copies of the exception. 
+		 * 				If stack traces are captured for the severity, the trace is captured with the exception 
+		 * 				and its frames are named when the message is formatted. An example usage is included below.
+		 * 	@code {.cpp}
+		 * 	throw logging::exception::error("Failed to open the device.", "Example", logging::severity::error);
+		 * 	@endcode
+		 */
+		class error : public std::runtime_error {
+		public:
+			/**
+			 * 	@brief 	Constructor for the error class.
+			 * 	@param 	message 	string message of the exception.
+			 * 	@param 	name 		string name of the component throwing the exception.
+			 * 	@param 	severity	logging::severity of the exception.
+			 * 	@param 	site 		throw_site the exception is created at, which should be left as the default.
+			 * 	@note	The exception is passed to the exception hook, if one is installed.
+			 */
+			error(
+				const std::string& message, 
+				std::string_view name,
+				logging::severity severity = logging::severity::error,
+				const throw_site& site = throw_site::current(&typeid(error))) :
+				std::runtime_error(message),
+				state(std::make_shared<formatted_state>(name, severity))
+			{
+				if (stack_trace::should_capture(severity)) {
+					state->frame_count = stack_trace::capture(state->frames.data(), state->frames.size());
+				}
+				notify_exception_hook(site, message, name, severity);
+			}
 
-			// Print the first line of the output in the format:
-			// [TIME] [SEVERITY] (NAME) MESSAGE LINE 1
-			ss 	<< std::left 
-				<< "[" << std::setw(time_template_width) << timestamp + "]" 
-				<< "[" << std::setw(Severity::get_max_severity_length() + 2) << std::string(Severity(severity)) + "]" 
-				<< "(" << std::string(name) + ") ";
-				
-			// Get the first line of the message (there is guaranteed to be 1).
-			std::string line = message_lines.front();
-			message_lines.pop_front();
+			/**
+			 * 	@brief 	Method what gets the formatted message, formatting it on the first call.
+			 * 	@return	const char* formatted message, or the unformatted message if formatting failed.
+			 */
+			const char* what() const noexcept override {
+				try {
+					threading::call_once(state->formatted_flag, [this]() {
+						if (state->frame_count == 0) {
+							format_message_as(state->formatted, get_message(), state->name, state->severity, state->time);
+						}
+						else {
+							// Follow the message with the trace, one frame per line.
+							format_buffer traced;
+							traced.append(get_message());
+							stack_trace::append_frames(state->frames.data(), state->frame_count, traced);
+							format_message_as(state->formatted, traced.view(), state->name, state->severity, state->time);
+						}
+						state->is_formatted.store(true);
+					});
+				}
+				catch (...) {}
+				return state->is_formatted.load() ? state->formatted.c_str() : std::runtime_error::what();
+			}
 
-			// Get the width of the preamble printed before the first line.
-			size_t preamble_width = ss.str().length();
+			/**
+			 * 	@brief 	Method get_message gets the message of the exception without formatting.
+			 * 	@return	std::string_view unformatted message.
+			 */
+			std::string_view get_message() const noexcept {
+				return std::runtime_error::what();
+			}
 
-			// Write the first line of the message to the string stream.
-			ss << line + "\n";
+			/**
+			 * 	@brief 	Method get_name gets the name of the component that threw the exception.
+			 * 	@return	std::string_view name of the component.
+			 */
+			std::string_view get_name() const noexcept {
+				return state->name;
+			}
 
-			// While there are remaining lines in the message,
-			while (!message_lines.empty()) {
-				// Get the line.
-				line = message_lines.front();
-				message_lines.pop_front();
+			/**
+			 * 	@brief 	Method get_severity gets the severity of the exception.
+			 * 	@return	logging::severity of the exception.
+			 */
+			logging::severity get_severity() const noexcept {
+				return state->severity;
+			}
 
-				// Write the line to the output right aligned with the rest of the lines.
-				ss << std::setw(preamble_width) << " " << line + "\n";
+			/**
+			 * 	@brief 	Method get_time gets the time the exception was created.
+			 * 	@return	std::chrono::system_clock::time_point time of the exception.
+			 */
+			std::chrono::system_clock::time_point get_time() const noexcept {
+				return state->time;
 			}
 
-			// Print the fully formatted string.
-			return ss.str();
+		private:
+			/**
+			 * 	@brief	Struct formatted_state holds the parts of the exception shared between its copies.
+			 */
+			struct formatted_state {
+				/**
+				 * 	@brief	Constructor for the formatted_state struct, which captures the current time.
+				 * 	@param	name 		string name of the component throwing the exception.
+				 * 	@param	severity	logging::severity of the exception.
+				 */
+				formatted_state(std::string_view name, logging::severity severity) :
+					time(std::chrono::system_clock::now()),
+					severity(severity),
+					name(name)
+				{}
+
+				/// Time the exception was created.
+				std::chrono::system_clock::time_point time;
+				/// Severity of the exception.
+				logging::severity severity;
+				/// Name of the component throwing the exception.
+				std::string name;
+				/// Flag to format the message only once, even from several threads.
+				threading::once_flag formatted_flag;
+				/// Flag for if the message was formatted successfully.
+				threading::atomic<bool> is_formatted{false};
+				/// Formatted message, once what() has been called.
+				std::string formatted;
+				/// Number of frames in the stack trace, which is 0 if no trace was captured.
+				size_t frame_count = 0;
+				/// Return addresses of the frames in the stack trace.
+				std::array<void*, stack_trace::MAX_FRAMES> frames;
+			};
+
+			/// State shared between copies of the exception, so copying it can't throw.
+			std::shared_ptr<formatted_state> state;
+		};
+
+		/// Number of spaces each cause in an exception chain is indented by, relative to the exception it caused.
+		const static inline size_t CAUSE_INDENT_WIDTH = 4;
+
+		/**
+		 * 	@brief 		Function layout_exception_chain writes an exception and the exceptions nested in it, e.g. by 
+		 * 				std::throw_with_nested, to an output.
+		 * 	@details	Each exception is written in the format returned by format_message, with each cause 
+		 * 				indented below the exception it caused. Exceptions created as an error are written 
+		 * 				from their parts, so their own formatted messages are never built. Other exceptions 
+		 * 				are named by their type.
+		 * 	@param 		exception 	std::exception outermost exception of the chain.
+		 * 	@param 		output 		output with append(std::string_view) and pad(size_t) methods to write to.
+		 * 	@param 		time 		std::chrono::system_clock::time_point time given to exceptions without one.
+		 * 	@param 		depth 		size_t depth of the exception in the chain, which should be left as the default.
+		 */
+		template <typename Output>
+		static void layout_exception_chain(
+			const std::exception& exception, 
+			Output& output,
+			std::chrono::system_clock::time_point time = std::chrono::system_clock::now(),
+			size_t depth = 0)
+		{
+			indented_output<Output> indented(output, depth * CAUSE_INDENT_WIDTH);
+			if (const auto* logged = dynamic_cast<const error*>(&exception)) {
+				layout_message(logged->get_message(), logged->get_name(), logged->get_severity(), logged->get_time(), indented);
+			}
+			else {
+				layout_message(exception.what(), stack_trace::demangle(typeid(exception).name()), severity::error, time, indented);
+			}
+
+			// Write the cause while it is being handled, which keeps it alive.
+			try {
+				std::rethrow_if_nested(exception);
+			}
+			catch (const std::exception& cause) {
+				layout_exception_chain(cause, output, time, depth + 1);
+			}
+			catch (...) {
+				indented_output<Output> unknown(output, (depth + 1) * CAUSE_INDENT_WIDTH);
+				layout_message("Unknown exception.", "unknown", severity::error, time, unknown);
+			}
+		}
+
+		/**
+		 * 	@brief 		Function format_exception_chain returns a formatted string with an exception and the 
+		 * 				exceptions nested in it, e.g. by std::throw_with_nested.
+		 * 	@details	The whole chain is formatted in one pass into the calling thread's format buffer, in 
+		 * 				the layout described by layout_exception_chain. An example usage is included below.
+		 * 	@param 		exception 	std::exception outermost exception of the chain.
+		 * 	@return 	std::string formatted string.
+		 * 	@code {.cpp}
+		 * 	try {
+		 * 		try {
+		 * 			throw logging::exception::error("Failed to read the block.", "Disk");
+		 * 		}
+		 * 		catch (...) {
+		 * 			std::throw_with_nested(logging::exception::error("Failed to load the file.", "Loader"));
+		 * 		}
+		 * 	}
+		 * 	catch (const std::exception& caught) {
+		 * 		std::cerr << logging::exception::format_exception_chain(caught);
+		 * 	}
+		 * 	@endcode
+		 */
+		static std::string format_exception_chain(const std::exception& exception) {
+			format_buffer& buffer = format_buffer::get_thread_buffer();
+			layout_exception_chain(exception, buffer);
+			return std::string(buffer.view());
 		}
 	}
 }
@@ -0,0 +1,225 @@
+/**
+ * 	@file		LogStackTrace.hpp
+ * 	@brief 		This file defines a class in the logging namespace for capturing stack traces cheaply and
+ * 				naming their frames later.
+ *	@date		2026-10-17
+ *	@author		agent
+ */
+
+#ifndef LOG_STACK_TRACE_HPP
+#define LOG_STACK_TRACE_HPP
+
+// System Libraries
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Platform Dependant System Libraries
+#ifdef _WIN32
+// Definition to prevent namespace clash of min/max on Windows
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+// Log Base Header
+#include "LogBase.hpp"
+
+namespace logging {
+	/**
+	 * 	@class		stack_trace
+	 * 	@brief 		Class stack_trace captures the return addresses of the frames on the stack, and names 
+	 * 				them when they are printed.
+	 * 	@details	Capturing the return addresses is cheap, but naming them is not, so frames are only
+	 * 				named when the trace is printed. Each address is named once and the name is cached, so
+	 * 				printing traces through the same frames again costs a lookup. Traces are captured for
+	 * 				console messages and exceptions once capture is enabled. An example usage is included below.
+	 * 	@code {.cpp}
+	 * 	logging::stack_trace::enable_capture(logging::severity::error);
+	 * 	@endcode
+	 * 	@note		Frames are named from the dynamic symbol table, so programs should be linked with
+	 * 				-rdynamic for functions outside of shared libraries to be named.
+	 */
+	class stack_trace {
+	public:
+		/// Maximum number of frames captured in a trace.
+		const static inline size_t MAX_FRAMES = 32;
+		/// Text written before the name of each frame when a trace is printed.
+		const static inline std::string_view FRAME_PREFIX = "\n    at ";
+
+		/**
+		 * 	@brief 	Static method capture captures the return addresses of the frames on the stack.
+		 * 	@param 	frames 		void* array to write the return addresses to.
+		 * 	@param 	max_frames 	size_t maximum number of frames to capture.
+		 * 	@param 	skip 		size_t number of frames to skip, not counting this method.
+		 * 	@return size_t number of frames captured.
+		 */
+		static size_t capture(void** frames, size_t max_frames, size_t skip = 0) noexcept {
+			// Capture the skipped frames too, then move the rest to the start of the array.
+			std::array<void*, MAX_FRAMES + 8> captured;
+			size_t captured_count = std::min(max_frames + skip + 1, captured.size());
+#ifdef _WIN32
+			captured_count = CaptureStackBackTrace(0, static_cast<DWORD>(captured_count), captured.data(), nullptr);
+#else
+			captured_count = std::max(backtrace(captured.data(), static_cast<int>(captured_count)), 0);
+#endif
+			if (captured_count <= skip + 1) {
+				return 0;
+			}
+			size_t frame_count = std::min(captured_count - skip - 1, max_frames);
+			std::copy_n(captured.begin() + skip + 1, frame_count, frames);
+			return frame_count;
+		}
+
+		/**
+		 * 	@brief 	Static method get_symbol names the frame a return address is in, e.g.
+		 * 			"function(int)+0x1c (libexample.so)".
+		 * 	@param 	address 	const void* return address of the frame.
+		 * 	@return std::string_view name of the frame, which stays valid for the life of the program.
+		 */
+		static std::string_view get_symbol(const void* address) {
+			std::scoped_lock<threading::mutex> lock(symbol_mutex);
+			auto cached = symbols.find(address);
+			if (cached == symbols.end()) {
+				cached = symbols.emplace(address, name_address(address)).first;
+			}
+			return cached->second;
+		}
+
+		/**
+		 * 	@brief 	Static method enable_capture starts capturing traces for messages and exceptions of at least
+		 * 			a severity.
+		 * 	@param 	minimum 	logging::severity lowest severity to capture traces for.
+		 */
+		static void enable_capture(logging::severity minimum = logging::severity::error) {
+			capture_minimum.store(minimum);
+			capture_enabled.store(true);
+		}
+
+		/**
+		 * 	@brief 	Static method disable_capture stops capturing traces, which is the default.
+		 */
+		static void disable_capture() {
+			capture_enabled.store(false);
+		}
+
+		/**
+		 * 	@brief 	Static method should_capture checks if traces are captured for a severity.
+		 * 	@param 	severity 	logging::severity to check.
+		 * 	@return bool true if traces should be captured for the severity.
+		 */
+		static bool should_capture(logging::severity severity) noexcept {
+			return capture_enabled.load(std::memory_order_relaxed) &&
+				severity >= capture_minimum.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * 	@brief 	Static method append_frames writes a trace to an output as one line per frame.
+		 * 	@details	The output is anything with append(std::string_view) and pad(size_t) methods. Each
+		 * 				frame is written as a newline followed by "    at NAME", so the trace can follow a
+		 * 				message that doesn't end with a newline.
+		 * 	@param 	frames 			void* array of return addresses.
+		 * 	@param 	frame_count 	size_t number of frames in the array.
+		 * 	@param 	output 			output to write the trace to.
+		 */
+		template <typename Output>
+		static void append_frames(void* const* frames, size_t frame_count, Output& output) {
+			for (size_t i = 0; i < frame_count; i++) {
+				output.append(FRAME_PREFIX);
+				output.append(get_symbol(frames[i]));
+			}
+		}
+
+		/**
+		 * 	@brief 	Static method lock takes the lock of the cached names, so fork never leaves it held by a thread 
+		 * 			the child doesn't have.
+		 */
+		static void lock() {
+			symbol_mutex.lock();
+		}
+
+		/**
+		 * 	@brief 	Static method unlock releases the lock taken by lock.
+		 */
+		static void unlock() {
+			symbol_mutex.unlock();
+		}
+
+		/**
+		 * 	@brief 	Static method demangle gets the readable name of a mangled C++ name, e.g. from typeid.
+		 * 	@param 	name 	const char* mangled name.
+		 * 	@return std::string readable name, or the name as it is if it can't be demangled.
+		 */
+		static std::string demangle(const char* name) {
+#ifdef _WIN32
+			return name;
+#else
+			int status = 0;
+			char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+			std::string readable = (status == 0 && demangled != nullptr) ? demangled : name;
+			std::free(demangled);
+			return readable;
+#endif
+		}
+
+	private:
+		/// Mutex to protect access to the cached names.
+		inline static threading::mutex symbol_mutex;
+		/// Names of the return addresses that have been named.
+		inline static std::unordered_map<const void*, std::string> symbols;
+		/// Flag for if traces are captured.
+		inline static threading::atomic<bool> capture_enabled{false};
+		/// Lowest severity traces are captured for.
+		inline static threading::atomic<logging::severity> capture_minimum{logging::severity::error};
+
+		/**
+		 * 	@brief 	Static method name_address names the frame a return address is in, without caching it.
+		 * 	@param 	address 	const void* return address of the frame.
+		 * 	@return std::string name of the frame.
+		 */
+		static std::string name_address(const void* address) {
+			char name[64];
+			std::snprintf(name, sizeof(name), "%p", address);
+			std::string symbol = name;
+#ifndef _WIN32
+			Dl_info info{};
+			if (dladdr(address, &info) == 0) {
+				return symbol;
+			}
+
+			// Name the function, demangling it if it is a C++ function.
+			const char* module = info.dli_fname != nullptr ? info.dli_fname : "";
+			std::string_view module_name = module;
+			module_name = module_name.substr(module_name.find_last_of('/') + 1);
+			if (info.dli_sname != nullptr) {
+				symbol = demangle(info.dli_sname);
+				std::snprintf(name, sizeof(name), "+0x%zx (",
+					static_cast<size_t>(static_cast<const char*>(address) - static_cast<const char*>(info.dli_saddr)));
+				symbol.append(name);
+				symbol.append(module_name);
+				symbol.append(")");
+			}
+			else {
+				// Otherwise name the offset into the module, which can be named offline with addr2line.
+				std::snprintf(name, sizeof(name), "+0x%zx",
+					static_cast<size_t>(static_cast<const char*>(address) - static_cast<const char*>(info.dli_fbase)));
+				symbol = module_name;
+				symbol.append(name);
+			}
+#endif
+			return symbol;
+		}
+	};
+}
+#endif /* LOG_STACK_TRACE_HPP */
@@ -1,8 +1,34 @@
 // C++ Standard Libraries
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <typeinfo>
+#include <vector>
+
+// System Libraries
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 // Unit Test Headers
 #include <catch2/benchmark/catch_benchmark_all.hpp>
@@ -13,6 +39,7 @@
 #include "LogBase.hpp"
 #include "LogConsole.hpp"
 #include "LogException.hpp"
+#include "LogStackTrace.hpp"
 
 
 /*************************************************************************************************/
@@ -61,6 +88,38 @@ int main( int argc, char* argv[] ) {
 	return result;
 }
 
+#ifndef _WIN32
+/**
+ * 	@brief	Function read_all reads a descriptor until it has nothing more to read, then closes it.
+ * 	@param	descriptor 	int descriptor to read, e.g. the read end of a pipe whose write end has been closed.
+ * 	@return	std::string everything read.
+ */
+static std::string read_all(int descriptor) {
+	std::string written;
+	std::array<char, 4096> buffer;
+	ssize_t length;
+	while ((length = read(descriptor, buffer.data(), buffer.size())) > 0) {
+		written.append(buffer.data(), length);
+	}
+	close(descriptor);
+	return written;
+}
+#endif
+
+/**
+ * 	@brief	Function count_occurrences counts the times a string appears in some output.
+ * 	@param	written 	std::string_view output to search.
+ * 	@param	message 	std::string_view string to count.
+ * 	@return	size_t number of times the string appears.
+ */
+static size_t count_occurrences(std::string_view written, std::string_view message) {
+	size_t found = 0;
+	for (size_t position = written.find(message); position != std::string_view::npos; position = written.find(message, position + 1)) {
+		found++;
+	}
+	return found;
+}
+
 
 
 /*************************************************************************************************/
@@ -130,6 +189,108 @@ TEST_CASE("Print example console output.", "[test][LogConsole][print][example]")
 	);
 }
 
+TEST_CASE("Print example wrapped console output.", "[test][LogConsole][print][example]") {
+	// Wrap at a fixed width, as stdout is not usually a terminal when testing.
+	logging::console::set_console_width(160);
+
+	REQUIRE_NOTHROW(
+		logging::console::print(
+			"Lines that are longer than the console are wrapped at the last space that fits, with the continuation lines in line with the message.",
+			"LogConsole Print Example",
+			logging::severity::info
+		)
+	);
+
+	REQUIRE_NOTHROW(
+		logging::console::print(
+			"Each line of a multi-line message is wrapped on its own,\nwhile words that are longer than the space left for the message, like https://github.com/jwehorner/logging-tools/blob/main/include/LogConsole.hpp, are broken at the console width.",
+			"LogConsole Print Example",
+			logging::severity::warning
+		)
+	);
+
+	logging::console::set_console_width(0);
+}
+
+TEST_CASE("Print example large console output.", "[test][LogConsole][print][example]") {
+	// Build a multi-KB payload dump, whose lines are written straight from the message.
+	std::string payload = "Payload dump:";
+	for (int i = 0; i < 64; i++) {
+		payload += "\n" + std::to_string(i) + ": " + std::string(300, 'a' + (i % 26));
+	}
+
+	REQUIRE_NOTHROW(
+		logging::console::print(
+			payload,
+			"LogConsole Large Example",
+			logging::severity::info
+		)
+	);
+}
+
+TEST_CASE("Print example coloured console output.", "[test][LogConsole][print][example]") {
+	logging::console::set_colour_output(true);
+
+	REQUIRE_NOTHROW(
+		logging::console::print(
+			"Info messages are not coloured,",
+			"LogConsole Colour Example",
+			logging::severity::info
+		)
+	);
+
+	REQUIRE_NOTHROW(
+		logging::console::print(
+			"Warnings are yellow,",
+			"LogConsole Colour Example",
+			logging::severity::warning
+		)
+	);
+
+	REQUIRE_NOTHROW(
+		logging::console::print(
+			"And errors are red,\nWithout the escape codes moving the continuation lines.",
+			"LogConsole Colour Example",
+			logging::severity::error
+		)
+	);
+
+	logging::console::set_colour_output(false);
+}
+
+TEST_CASE("Print example status line.", "[test][LogConsole][status][example]") {
+	// The status line is only drawn when stdout is a terminal.
+	REQUIRE_NOTHROW(logging::console::set_status("LogConsole Status Example", 100));
+
+	for (uint64_t i = 1; i <= 100; i++) {
+		REQUIRE_NOTHROW(logging::console::set_progress(i));
+		if (i % 25 == 0) {
+			REQUIRE_NOTHROW(
+				logging::console::get_instance().print_parallel(
+					"Messages are printed above the status line.",
+					"LogConsole Status Example",
+					logging::severity::info
+				)
+			);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	REQUIRE_NOTHROW(logging::console::clear_status());
+}
+
+TEST_CASE("Check flush of buffered console output.", "[test][LogConsole][flush]") {
+	REQUIRE_NOTHROW(
+		logging::console::print(
+			"When stdout is a pipe or file this message is buffered until it is flushed.",
+			"LogConsole Flush Example",
+			logging::severity::info
+		)
+	);
+
+	REQUIRE_NOTHROW(logging::console::flush());
+}
+
 TEST_CASE("Benchmark print console output.", "[benchmark][LogConsole][print]") {
 	BENCHMARK("Benchmark simple print.") {
 		return logging::console::print(
@@ -140,6 +301,94 @@ TEST_CASE("Benchmark print console output.", "[benchmark][LogConsole][print]") {
 	};
 }
 
+#ifndef _WIN32
+TEST_CASE("Benchmark buffered and direct output to a file.", "[benchmark][LogConsole][flush]") {
+	/**
+	 * 	@brief	Struct sink_access exposes the console's output sink and buffer, to write to a file through them.
+	 */
+	struct sink_access : logging::console_base {
+		using console_base::gather_buffer;
+		using console_base::output_sink;
+	};
+	std::FILE* file = std::tmpfile();
+	REQUIRE(file != nullptr);
+	sink_access::output_sink sink(fileno(file));
+	sink_access::gather_buffer output;
+	output.append("[INFO] (LogConsole Flush Benchmark) BenchmarkFlush1\n");
+
+	// Direct writes take a system call for every message, as a terminal does.
+	BENCHMARK("Benchmark writing each message to a file.") {
+		return sink.write(output, true);
+	};
+	// Buffered writes take a system call for every 64 KiB of messages, as a pipe or file does.
+	sink.set_flushed_later(true);
+	BENCHMARK("Benchmark buffering messages to a file.") {
+		return sink.write(output);
+	};
+	sink.flush();
+	std::fclose(file);
+}
+#endif
+
+#ifndef _WIN32
+TEST_CASE("Benchmark print to a file descriptor.", "[benchmark][LogConsole][print]") {
+	// Reference implementation of print that builds each message in a new stringstream and writes it under a 
+	// mutex, as it was before messages were laid out in the thread's gather buffer.
+	std::mutex reference_mutex;
+	unsigned int reference_name_width = 40;
+	auto print_stringstream = [&](int descriptor, const std::string& message, const std::string& name, logging::severity severity) {
+		reference_name_width = std::max(reference_name_width, (unsigned int)name.length());
+		std::string timestamp = logging::generate_timestamp();
+		std::deque<std::string> message_lines = logging::split_string(message, "\n");
+		std::stringstream ss;
+		ss 	<< std::left 
+			<< "[" << std::setw(logging::time_template_width) << timestamp + "]" 
+			<< "[" << std::setw(logging::Severity::get_max_severity_length() + 2) << std::string(logging::Severity(severity)) + "]" 
+			<< "(" << std::setw(reference_name_width + 2) << std::string(name) + ")";
+		std::string line = message_lines.front();
+		message_lines.pop_front();
+		size_t preamble_width = ss.str().length();
+		ss << line + "\n";
+		while (!message_lines.empty()) {
+			line = message_lines.front();
+			message_lines.pop_front();
+			ss << std::setw(preamble_width) << " " << line + "\n";
+		}
+		std::scoped_lock<std::mutex> lock(reference_mutex);
+		std::string output = ss.str();
+		return write(descriptor, output.data(), output.length());
+	};
+
+	// Both print to /dev/null, so the benchmarks measure formatting and writing rather than a reader.
+	int null_descriptor = open("/dev/null", O_WRONLY);
+	REQUIRE(null_descriptor >= 0);
+	logging::config configuration;
+	configuration.output_descriptor = null_descriptor;
+	logging::init(configuration);
+
+	BENCHMARK("Benchmark print with a stringstream per call (before).") {
+		return print_stringstream(
+			null_descriptor,
+			"BenchmarkPrint1\nOver two lines.",
+			"LogConsole Print Benchmark",
+			logging::severity::info
+		);
+	};
+
+	BENCHMARK("Benchmark print laid out in the thread's gather buffer (after).") {
+		return logging::console::print(
+			"BenchmarkPrint1\nOver two lines.",
+			"LogConsole Print Benchmark",
+			logging::severity::info
+		);
+	};
+
+	logging::shutdown();
+	logging::init();
+	close(null_descriptor);
+}
+#endif
+
 TEST_CASE("Print parallel example console output.", "[test][LogConsole][print_parallel][example]") {
 	REQUIRE_NOTHROW(
 		logging::console::get_instance().print_parallel(
@@ -177,6 +426,656 @@ TEST_CASE("Print parallel example console output.", "[test][LogConsole][print_pa
 	std::this_thread::sleep_for(std::chrono::milliseconds(10));
 }
 
+TEST_CASE("Print parallel shared example console output.", "[test][LogConsole][print_parallel][example]") {
+	// Build a large diagnostic dump that is handed to the print thread without being copied.
+	std::string dump = "Diagnostic dump:";
+	for (int i = 0; i < 32; i++) {
+		dump += "\n" + std::to_string(i) + ": " + std::string(300, 'a' + (i % 26));
+	}
+	auto shared_dump = std::make_shared<const std::string>(std::move(dump));
+	std::weak_ptr<const std::string> weak_dump = shared_dump;
+
+	REQUIRE_NOTHROW(
+		logging::console::get_instance().print_parallel(
+			std::move(shared_dump),
+			"LogConsole Print Parallel Shared Example",
+			logging::severity::info
+		)
+	);
+
+	// Give the thread a chance to print before checking the dump was released.
+	for (int i = 0; i < 100 && !weak_dump.expired(); i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	REQUIRE(weak_dump.expired());
+}
+
+TEST_CASE("Print streamed record example console output.", "[test][LogConsole][begin_record][example]") {
+	auto writer = logging::console::get_instance().begin_record(
+		"LogConsole Streamed Record Example",
+		logging::severity::info
+	);
+
+	// Write the record in pieces that split lines, and enough of them to fill several chunks.
+	REQUIRE_NOTHROW(writer.write("Records can be written in pie").write("ces,\nwith lines split across them."));
+	for (int i = 0; i < 32; i++) {
+		REQUIRE_NOTHROW(writer.write("\nStreamed line ").write(std::to_string(i)).write(": ").write(std::string(200, 'a' + (i % 26))));
+	}
+	REQUIRE_NOTHROW(writer.commit());
+
+	// Writing once a record has been committed, or to a writer that has been moved from, does nothing.
+	REQUIRE_NOTHROW(writer.write("This piece is never printed.").commit());
+	auto moved_from = logging::console::get_instance().begin_record(
+		"LogConsole Streamed Record Example",
+		logging::severity::info
+	);
+	auto moved_to = std::move(moved_from);
+	REQUIRE_NOTHROW(moved_from.write("This piece is never printed."));
+	REQUIRE_NOTHROW(moved_to.write("Records can be moved before they are committed.").commit());
+
+	// Records that are not committed are discarded.
+	{
+		auto discarded = logging::console::get_instance().begin_record(
+			"LogConsole Streamed Record Example",
+			logging::severity::error
+		);
+		REQUIRE_NOTHROW(discarded.write("This record is never printed."));
+	}
+
+	// Give the thread a chance to print before exiting.
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+TEST_CASE("Print parallel batch example console output.", "[test][LogConsole][print_parallel_batch][example]") {
+	std::vector<std::string> lines;
+	for (int i = 0; i < 10; i++) {
+		lines.push_back("Batch line " + std::to_string(i) + " is printed contiguously with the rest of the batch.");
+	}
+
+	REQUIRE_NOTHROW(
+		logging::console::get_instance().print_parallel_batch(
+			lines,
+			"LogConsole Print Parallel Batch Example",
+			logging::severity::info
+		)
+	);
+
+	REQUIRE_NOTHROW(
+		logging::console::get_instance().print_parallel_batch(
+			std::array<std::string_view, 2>{"Batches can be any container", "of strings or string views."},
+			"LogConsole Print Parallel Batch Example",
+			logging::severity::warning
+		)
+	);
+
+	// Give the thread a chance to print before exiting.
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+#ifndef _WIN32
+TEST_CASE("Check init and shutdown of the console.", "[test][LogConsole][init]") {
+	// Configure the console to allocate from a pool and write to a pipe, then log through it.
+	static std::pmr::synchronized_pool_resource pool;
+	int pipe_descriptors[2];
+	REQUIRE(pipe(pipe_descriptors) == 0);
+	logging::config configuration;
+	configuration.queue_capacity = 256;
+	configuration.memory_resource = &pool;
+	configuration.output_descriptor = pipe_descriptors[1];
+	logging::init(configuration);
+	REQUIRE(logging::console::get_instance().get_memory_resource() == &pool);
+
+	logging::console::get_instance().print_parallel("Written to the configured sink.", "LogConsole Init Example", logging::severity::info);
+	logging::shutdown();
+
+	// The thread starts again when there is more to print.
+	logging::console::get_instance().print_parallel("Written after a restart.", "LogConsole Init Example", logging::severity::info);
+	logging::shutdown();
+
+	// Restore the default settings before the pool is destroyed, then read what was written.
+	logging::config defaults;
+	defaults.memory_resource = std::pmr::get_default_resource();
+	logging::init(defaults);
+	close(pipe_descriptors[1]);
+	std::string written = read_all(pipe_descriptors[0]);
+	REQUIRE(written.find("(LogConsole Init Example)") != std::string::npos);
+	REQUIRE(written.find("Written to the configured sink.\n") < written.find("Written after a restart.\n"));
+	REQUIRE(written.find("Written after a restart.\n") != std::string::npos);
+}
+#endif
+
+#ifndef _WIN32
+TEST_CASE("Check a batch starts the console and a new resource is used after configure.", "[test][LogConsole][init]") {
+	/**
+	 * 	@brief	Class counting_resource counts the allocations it passes to the default resource.
+	 */
+	class counting_resource : public std::pmr::memory_resource {
+	public:
+		std::atomic<size_t> allocations{0};
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override {
+			allocations++;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+			std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+		}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+			return this == &other;
+		}
+	};
+	counting_resource first;
+	counting_resource second;
+	int pipe_descriptors[2];
+	REQUIRE(pipe(pipe_descriptors) == 0);
+	logging::config configuration;
+	configuration.output_descriptor = pipe_descriptors[1];
+	configuration.memory_resource = &first;
+	{
+		// Once the resource changes, the queue and its swaps allocate from the new one.
+		logging::console console(configuration);
+		configuration.memory_resource = &second;
+		configuration.queue_capacity = 64;
+		console.configure(configuration);
+		size_t first_allocations = first.allocations.load();
+
+		// A batch queued first starts the print thread, which prints it without waiting for a shutdown.
+		std::vector<std::string> lines(10, "Printed from the first batch, which is long enough to allocate.");
+		console.print_parallel_batch(lines, "LogConsole Init Example", logging::severity::info);
+#ifndef LOGGING_SINGLE_THREADED
+		pollfd written{pipe_descriptors[0], POLLIN, 0};
+		REQUIRE(poll(&written, 1, 5000) == 1);
+#endif
+		console.stop();
+		REQUIRE(first.allocations.load() == first_allocations);
+		REQUIRE(second.allocations.load() > 0);
+	}
+	close(pipe_descriptors[1]);
+	std::string written = read_all(pipe_descriptors[0]);
+	REQUIRE(count_occurrences(written, "Printed from the first batch, which is long enough to allocate.\n") == 10);
+}
+
+TEST_CASE("Check independent consoles print to their own sinks.", "[test][LogConsole][instances]") {
+	int first_pipe[2];
+	int second_pipe[2];
+	REQUIRE(pipe(first_pipe) == 0);
+	REQUIRE(pipe(second_pipe) == 0);
+	{
+		// Each console has its own queue, thread, sink and name column.
+		logging::config configuration;
+		configuration.output_descriptor = first_pipe[1];
+		configuration.max_name_length = 10;
+		logging::console first(configuration);
+		configuration.output_descriptor = second_pipe[1];
+		logging::console second(configuration);
+
+		second.print_parallel("Printed before the long name.", "Second", logging::severity::info);
+		second.stop();
+		first.print_parallel("Printed with a long name.", "An Independent Console With A Long Name", logging::severity::info);
+		first.stop();
+		second.print_parallel("Printed after the long name.", "Second", logging::severity::info);
+	}
+	close(first_pipe[1]);
+	close(second_pipe[1]);
+	std::string first_written = read_all(first_pipe[0]);
+	std::string second_written = read_all(second_pipe[0]);
+	REQUIRE(first_written.find("(An Independent Console With A Long Name) Printed with a long name.\n") != std::string::npos);
+	REQUIRE(first_written.find("Second") == std::string::npos);
+
+	// The long name in the first console doesn't widen the second console's name column.
+	size_t before = second_written.find("Printed before the long name.");
+	size_t after = second_written.find("Printed after the long name.");
+	REQUIRE(before != std::string::npos);
+	REQUIRE(after != std::string::npos);
+	REQUIRE(before - second_written.rfind('\n', before) == after - second_written.rfind('\n', after));
+	REQUIRE(second_written.find("(Second)     Printed before") != std::string::npos);
+}
+
+TEST_CASE("Check independent consoles don't wrap at stdout's width.", "[test][LogConsole][instances]") {
+	int pipe_descriptors[2];
+	REQUIRE(pipe(pipe_descriptors) == 0);
+	std::string message(200, 'w');
+	logging::console::set_console_width(80);
+	{
+		// The width is stdout's, so a console writing to a pipe lays its lines out in full.
+		logging::config configuration;
+		configuration.output_descriptor = pipe_descriptors[1];
+		logging::console console(configuration);
+		console.print_parallel(message, "LogConsole Wrap Example", logging::severity::info);
+	}
+	logging::console::set_console_width(0);
+	close(pipe_descriptors[1]);
+	std::string written = read_all(pipe_descriptors[0]);
+	REQUIRE(written.find(message + "\n") != std::string::npos);
+	REQUIRE(count_occurrences(written, "\n") == 1);
+}
+
+TEST_CASE("Check consoles with compile time policies.", "[test][LogConsole][policies]") {
+	int drop_pipe[2];
+	int block_pipe[2];
+	REQUIRE(pipe(drop_pipe) == 0);
+	REQUIRE(pipe(block_pipe) == 0);
+	logging::config configuration;
+	{
+		// A bounded queue that drops what doesn't fit, drained by hand so that it fills.
+		using dropping_console = logging::basic_console<
+			4,
+			4096,
+			logging::overflow::drop,
+			logging::clocks::coarse,
+			logging::threading::spin_mutex>;
+		configuration.output_descriptor = drop_pipe[1];
+		configuration.external_drain = true;
+		dropping_console console(configuration);
+		std::vector<std::string> lines(6, "Printed by a bounded console.");
+		console.print_parallel_batch(lines, "LogConsole Policy Example", logging::severity::info);
+		console.print_parallel("Dropped by a bounded console.", "LogConsole Policy Example", logging::severity::info);
+		REQUIRE(console.get_dropped_count() == 3);
+		REQUIRE(console.drain() == 4);
+		console.print_parallel("Printed once the queue was drained.", "LogConsole Policy Example", logging::severity::info);
+		REQUIRE(console.drain() == 1);
+	}
+	{
+		// A bounded queue that makes producers wait, with chunks smaller than the streamed message.
+		using blocking_console = logging::basic_console<2, 64, logging::overflow::block>;
+		configuration.output_descriptor = block_pipe[1];
+		configuration.external_drain = false;
+		blocking_console console(configuration);
+		for (int i = 0; i < 100; i++) {
+			console.print_parallel("Printed by a blocking console.", "LogConsole Policy Example", logging::severity::info);
+		}
+		console.begin_record("LogConsole Policy Example", logging::severity::info).write(std::string(200, '#')).commit();
+	}
+	close(drop_pipe[1]);
+	close(block_pipe[1]);
+	std::string dropped_written = read_all(drop_pipe[0]);
+	std::string blocked_written = read_all(block_pipe[0]);
+	REQUIRE(count_occurrences(dropped_written, "Printed by a bounded console.\n") == 4);
+	REQUIRE(dropped_written.find("Dropped by a bounded console.") == std::string::npos);
+	REQUIRE(dropped_written.find("(LogConsole)") != std::string::npos);
+	REQUIRE(dropped_written.find("Dropped 3 messages because the print queue was full.\n") != std::string::npos);
+	REQUIRE(dropped_written.find("Printed once the queue was drained.\n") != std::string::npos);
+	REQUIRE(count_occurrences(blocked_written, "Printed by a blocking console.\n") == 100);
+	REQUIRE(blocked_written.find(std::string(200, '#') + "\n") != std::string::npos);
+}
+
+TEST_CASE("Check records are allocated from huge pages.", "[test][LogConsole][huge_pages]") {
+	{
+		// The region is rounded up to whole huge pages, and blocks that don't fit come from upstream.
+		logging::huge_page_resource resource(3 * 1024 * 1024);
+		REQUIRE(resource.get_size() == 2 * logging::huge_page_resource::HUGE_PAGE_SIZE);
+		void* small = resource.allocate(64, 8);
+		void* large = resource.allocate(8 * 1024 * 1024, 64);
+		REQUIRE(resource.contains(small));
+		REQUIRE_FALSE(resource.contains(large));
+		REQUIRE(resource.get_overflow_count() == 1);
+		std::memset(large, 0, 8 * 1024 * 1024);
+		resource.deallocate(small, 64, 8);
+		resource.deallocate(large, 8 * 1024 * 1024, 64);
+
+		// Blocks too large to be pooled are given back to the region and reused, so cycling them never 
+		// overflows.
+		void* first = resource.allocate(64 * 1024, 64);
+		REQUIRE(resource.contains(first));
+		resource.deallocate(first, 64 * 1024, 64);
+		REQUIRE(resource.allocate(64 * 1024, 64) == first);
+		resource.deallocate(first, 64 * 1024, 64);
+		for (int cycle = 0; cycle < 200; cycle++) {
+			for (size_t size : {size_t(64 * 1024), size_t(1024 * 1024)}) {
+				void* block = resource.allocate(size, 64);
+				REQUIRE(resource.contains(block));
+				std::memset(block, 0, size);
+				resource.deallocate(block, size, 64);
+			}
+		}
+		REQUIRE(resource.get_overflow_count() == 1);
+	}
+	int pipe_descriptors[2];
+	REQUIRE(pipe(pipe_descriptors) == 0);
+	logging::config configuration;
+	configuration.output_descriptor = pipe_descriptors[1];
+	configuration.huge_page_bytes = 4 * 1024 * 1024;
+	{
+		logging::console console(configuration);
+		REQUIRE(dynamic_cast<logging::huge_page_resource*>(console.get_memory_resource()) != nullptr);
+		for (int i = 0; i < 100; i++) {
+			console.print_parallel("Printed from huge pages.", "LogConsole Huge Page Example", logging::severity::info);
+		}
+		console.begin_record("LogConsole Huge Page Example", logging::severity::info).write(std::string(10000, '#')).commit();
+	}
+	close(pipe_descriptors[1]);
+	std::string written = read_all(pipe_descriptors[0]);
+	REQUIRE(count_occurrences(written, "Printed from huge pages.\n") == 100);
+	REQUIRE(written.find(std::string(10000, '#') + "\n") != std::string::npos);
+}
+
+TEST_CASE("Check prefaulted storage doesn't grow in steady state.", "[test][LogConsole][prefault]") {
+	int steady_pipe[2];
+	int grown_pipe[2];
+	REQUIRE(pipe(steady_pipe) == 0);
+	REQUIRE(pipe(grown_pipe) == 0);
+	logging::config configuration;
+	configuration.prefault_memory = true;
+	configuration.lock_memory = true;
+	configuration.external_drain = true;
+	{
+		// A queue and huge pages sized for the load never allocate more storage.
+		configuration.output_descriptor = steady_pipe[1];
+		configuration.queue_capacity = 64;
+		configuration.huge_page_bytes = 2 * 1024 * 1024;
+		logging::console console(configuration);
+		for (int round = 0; round < 5; round++) {
+			for (int i = 0; i < 32; i++) {
+				console.print_parallel("Printed from prefaulted storage.", "LogConsole Prefault Example", logging::severity::info);
+			}
+			console.begin_record("LogConsole Prefault Example", logging::severity::info).write(std::string(1000, '#')).commit();
+			REQUIRE(console.drain() == 33);
+		}
+		REQUIRE(console.get_memory_growth() == 0);
+	}
+	{
+		// Without huge pages, names and messages too long to be stored in place come from a prefaulted region.
+		int null_descriptor = open("/dev/null", O_WRONLY);
+		REQUIRE(null_descriptor >= 0);
+		configuration.output_descriptor = null_descriptor;
+		configuration.huge_page_bytes = 0;
+		logging::console console(configuration);
+		logging::huge_page_resource* region = dynamic_cast<logging::huge_page_resource*>(console.get_memory_resource());
+		REQUIRE(region != nullptr);
+		REQUIRE(region->get_size() > 0);
+		std::vector<std::string> lines(16, std::string(200, '-'));
+		for (int round = 0; round < 5; round++) {
+			for (int i = 0; i < 32; i++) {
+				console.print_parallel(std::string(300, '='), "LogConsole Prefault Example", logging::severity::info);
+			}
+			console.print_parallel_batch(lines, "LogConsole Prefault Example", logging::severity::info);
+			REQUIRE(console.drain() == 48);
+		}
+		REQUIRE(console.get_memory_growth() == 0);
+
+		// Output too long for the prefaulted buffer makes it grow.
+		std::string short_lines;
+		for (int i = 0; i < 10000; i++) {
+			short_lines.append("Short line.\n");
+		}
+		console.print_parallel(short_lines, "LogConsole Prefault Example", logging::severity::info);
+		REQUIRE(console.drain() == 1);
+		REQUIRE(console.get_memory_growth() > 0);
+		console.stop();
+		close(null_descriptor);
+	}
+	{
+		// A queue too small for the load grows, which is reported when it is next printed.
+		configuration.output_descriptor = grown_pipe[1];
+		configuration.queue_capacity = 4;
+		configuration.huge_page_bytes = 0;
+		logging::console console(configuration);
+		for (int i = 0; i < 8; i++) {
+			console.print_parallel("Printed from a queue that grew.", "LogConsole Prefault Example", logging::severity::info);
+		}
+		REQUIRE(console.get_memory_growth() > 0);
+		REQUIRE(console.drain() == 8);
+	}
+	close(steady_pipe[1]);
+	close(grown_pipe[1]);
+	std::string steady_written = read_all(steady_pipe[0]);
+	std::string grown_written = read_all(grown_pipe[0]);
+	REQUIRE(steady_written.find("after it was prefaulted") == std::string::npos);
+	REQUIRE(steady_written.find("Printed from prefaulted storage.\n") != std::string::npos);
+	REQUIRE(grown_written.find("(LogConsole)") != std::string::npos);
+	REQUIRE(grown_written.find("after it was prefaulted, so queue_capacity or huge_page_bytes should be raised.\n") != std::string::npos);
+}
+
+TEST_CASE("Check messages are printed from the queue shards of each NUMA node.", "[test][LogConsole][numa_shards]") {
+	int pipe_descriptors[2];
+	REQUIRE(pipe(pipe_descriptors) == 0);
+	logging::config configuration;
+	configuration.output_descriptor = pipe_descriptors[1];
+	configuration.numa_shards = true;
+	{
+		// Producers on every CPU queue into the shard of their node, wherever the print thread runs.
+		logging::console console(configuration);
+		std::vector<std::string> lines(10, "Printed in a batch from a shard.");
+		unsigned int cpu_count = std::max(std::thread::hardware_concurrency(), 1u);
+		for (unsigned int cpu = 0; cpu < cpu_count; cpu++) {
+			auto produce = [&] {
+				console.print_parallel("Printed from a shard.", "LogConsole NUMA Example", logging::severity::info);
+				console.print_parallel_batch(lines, "LogConsole NUMA Example", logging::severity::info);
+			};
+#if defined(__linux__) && !defined(LOGGING_SINGLE_THREADED)
+			std::thread producer([&] {
+				cpu_set_t cpus;
+				CPU_ZERO(&cpus);
+				CPU_SET(cpu, &cpus);
+				pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+				produce();
+			});
+			producer.join();
+#else
+			produce();
+#endif
+		}
+	}
+	close(pipe_descriptors[1]);
+	std::string written = read_all(pipe_descriptors[0]);
+	size_t singles = count_occurrences(written, "Printed from a shard.\n");
+	size_t batched = count_occurrences(written, "Printed in a batch from a shard.\n");
+	REQUIRE(singles == std::max(std::thread::hardware_concurrency(), 1u));
+	REQUIRE(batched == 10 * singles);
+}
+
+TEST_CASE("Check messages are printed by drain from an external event loop.", "[test][LogConsole][drain]") {
+	int pipe_descriptors[2];
+	REQUIRE(pipe(pipe_descriptors) == 0);
+	fcntl(pipe_descriptors[0], F_SETFL, O_NONBLOCK);
+	logging::config configuration;
+	configuration.output_descriptor = pipe_descriptors[1];
+	configuration.external_drain = true;
+	logging::init(configuration);
+	logging::console& console = logging::console::get_instance();
+	int event_descriptor = console.get_event_descriptor();
+	REQUIRE(event_descriptor >= 0);
+
+	// Nothing is printed until the loop sees the descriptor is readable and drains the queue.
+	pollfd event{event_descriptor, POLLIN, 0};
+	REQUIRE(poll(&event, 1, 0) == 0);
+	std::vector<std::string> lines(10, "Printed by drain.");
+	console.print_parallel_batch(lines, "LogConsole Drain Example", logging::severity::info);
+	console.print_parallel("Printed by a later drain.", "LogConsole Drain Example", logging::severity::info);
+	REQUIRE(poll(&event, 1, 0) == 1);
+	std::array<char, 4096> buffer;
+	REQUIRE(read(pipe_descriptors[0], buffer.data(), buffer.size()) < 0);
+
+	// Draining part of the queue leaves the descriptor readable for the rest.
+	REQUIRE(console.drain(10) == 10);
+	REQUIRE(poll(&event, 1, 0) == 1);
+	REQUIRE(console.drain() == 1);
+	REQUIRE(poll(&event, 1, 0) == 0);
+	REQUIRE(console.drain() == 0);
+
+	logging::init();
+	close(pipe_descriptors[1]);
+	std::string written = read_all(pipe_descriptors[0]);
+	REQUIRE(written.find("Printed by drain.\n") < written.find("Printed by a later drain.\n"));
+	REQUIRE(written.find("Printed by a later drain.\n") != std::string::npos);
+}
+#endif
+
+#if defined(__linux__) && !defined(LOGGING_SINGLE_THREADED)
+TEST_CASE("Check the print thread applies its configured settings.", "[test][LogConsole][thread_config]") {
+	// Pin the print thread to the first CPU and name it.
+	logging::config configuration;
+	configuration.print_thread.cpus = {0};
+	configuration.print_thread.name = "logging-test";
+	logging::init(configuration);
+	logging::console::get_instance().print_parallel("Printed from a named, pinned thread.", "LogConsole Thread Example", logging::severity::info);
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	// Find the thread by its name and check which CPUs it may run on.
+	std::string allowed_cpus;
+	for (const auto& task : std::filesystem::directory_iterator("/proc/self/task")) {
+		std::ifstream comm(task.path() / "comm");
+		std::string name;
+		std::getline(comm, name);
+		if (name == "logging-test") {
+			std::ifstream status(task.path() / "status");
+			std::string line;
+			while (std::getline(status, line)) {
+				if (line.rfind("Cpus_allowed_list:", 0) == 0) {
+					allowed_cpus = line.substr(line.find_first_not_of(" \t", line.find(':') + 1));
+				}
+			}
+		}
+	}
+	logging::init();
+	REQUIRE(allowed_cpus == "0");
+}
+#endif
+
+#if !defined(_WIN32) && !defined(LOGGING_SINGLE_THREADED)
+TEST_CASE("Check the console keeps working in a forked child.", "[test][LogConsole][fork]") {
+	// Write the parent and the child to separate pipes, dropping the parent's queue in the child.
+	int parent_pipe[2];
+	int child_pipe[2];
+	REQUIRE(pipe(parent_pipe) == 0);
+	REQUIRE(pipe(child_pipe) == 0);
+	logging::config configuration;
+	configuration.output_descriptor = parent_pipe[1];
+	configuration.on_fork = logging::fork_policy::discard;
+	configuration.child_output_descriptor = child_pipe[1];
+	logging::init(configuration);
+
+	// Read the parent's pipe as it is written, so the parent never blocks on a full pipe.
+	std::string parent_written;
+	std::thread parent_reader([&]() {
+		parent_written = read_all(parent_pipe[0]);
+	});
+
+	// Keep printing from another thread while forking, so the fork happens part way through.
+	std::atomic_bool printing{true};
+	std::thread printer([&printing]() {
+		while (printing.load()) {
+			logging::console::get_instance().print_parallel("Printed by the parent.", "LogConsole Fork Example", logging::severity::info);
+		}
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	pid_t child = fork();
+	if (child == 0) {
+		// The child must print through a new thread, and exit without returning to the test.
+		alarm(5);
+		logging::console::get_instance().print_parallel("Printed by the child.", "LogConsole Fork Example", logging::severity::info);
+		logging::shutdown();
+		_exit(0);
+	}
+	printing.store(false);
+	printer.join();
+	REQUIRE(child > 0);
+	int status = 0;
+	REQUIRE(waitpid(child, &status, 0) == child);
+	REQUIRE(WIFEXITED(status));
+	REQUIRE(WEXITSTATUS(status) == 0);
+
+	// Restore the default settings, then read what each process wrote.
+	logging::init();
+	close(parent_pipe[1]);
+	close(child_pipe[1]);
+	parent_reader.join();
+	std::string child_written = read_all(child_pipe[0]);
+	REQUIRE(parent_written.find("Printed by the parent.\n") != std::string::npos);
+	REQUIRE(parent_written.find("Printed by the child.") == std::string::npos);
+	REQUIRE(child_written.find("Printed by the child.\n") != std::string::npos);
+	REQUIRE(child_written.find("Printed by the parent.") == std::string::npos);
+}
+
+TEST_CASE("Check a forked child keeps or drops queued messages written in pieces.", "[test][LogConsole][fork]") {
+	for (bool numa_shards : {false, true}) {
+		for (logging::fork_policy on_fork : {logging::fork_policy::discard, logging::fork_policy::preserve}) {
+			int parent_pipe[2];
+			int child_pipe[2];
+			REQUIRE(pipe(parent_pipe) == 0);
+			REQUIRE(pipe(child_pipe) == 0);
+			logging::config configuration;
+			configuration.output_descriptor = parent_pipe[1];
+			configuration.child_output_descriptor = child_pipe[1];
+			configuration.on_fork = on_fork;
+			configuration.external_drain = true;
+			configuration.numa_shards = numa_shards;
+			{
+				// The record holds chunks from the pool when the process forks, which the child frees or prints.
+				logging::console console(configuration);
+				console.begin_record("LogConsole Fork Example", logging::severity::info).write(std::string(10000, '#')).commit();
+				pid_t child = fork();
+				if (child == 0) {
+					alarm(5);
+					console.print_parallel("Printed by the child.", "LogConsole Fork Example", logging::severity::info);
+					console.drain();
+					console.flush_sink();
+					_exit(0);
+				}
+				REQUIRE(child > 0);
+				int status = 0;
+				REQUIRE(waitpid(child, &status, 0) == child);
+				REQUIRE(WIFEXITED(status));
+				REQUIRE(WEXITSTATUS(status) == 0);
+				REQUIRE(console.drain() == 1);
+			}
+			close(parent_pipe[1]);
+			close(child_pipe[1]);
+			std::string parent_written = read_all(parent_pipe[0]);
+			std::string child_written = read_all(child_pipe[0]);
+			REQUIRE(parent_written.find(std::string(10000, '#') + "\n") != std::string::npos);
+			REQUIRE(child_written.find("Printed by the child.\n") != std::string::npos);
+			REQUIRE((child_written.find(std::string(10000, '#') + "\n") != std::string::npos) == (on_fork == logging::fork_policy::preserve));
+		}
+	}
+}
+#endif
+
+#if defined(LOGGING_SINGLE_THREADED) && !defined(_WIN32)
+TEST_CASE("Check single threaded builds print from the calling thread.", "[test][LogConsole][single_threaded]") {
+	int pipe_descriptors[2];
+	REQUIRE(pipe(pipe_descriptors) == 0);
+	fcntl(pipe_descriptors[0], F_SETFL, O_NONBLOCK);
+	logging::config configuration;
+	configuration.output_descriptor = pipe_descriptors[1];
+	logging::init(configuration);
+
+	// The message is formatted straight away and buffered, so it is written once the console is flushed.
+	logging::console::get_instance().print_parallel("Printed by the calling thread.", "LogConsole Single Threaded Example", logging::severity::info);
+	std::array<char, 4096> buffer;
+	REQUIRE(read(pipe_descriptors[0], buffer.data(), buffer.size()) < 0);
+	logging::console::flush();
+	ssize_t length = read(pipe_descriptors[0], buffer.data(), buffer.size());
+	REQUIRE(length > 0);
+	REQUIRE(std::string_view(buffer.data(), length).find("Printed by the calling thread.\n") != std::string_view::npos);
+
+	// Errors and print are written straight away, after the output buffered before them.
+	logging::console::get_instance().print_parallel("Buffered before an error.", "LogConsole Single Threaded Example", logging::severity::info);
+	logging::console::get_instance().print_parallel("Printed as an error.", "LogConsole Single Threaded Example", logging::severity::error);
+	length = read(pipe_descriptors[0], buffer.data(), buffer.size());
+	REQUIRE(length > 0);
+	std::string_view written(buffer.data(), length);
+	REQUIRE(written.find("Buffered before an error.\n") < written.find("Printed as an error.\n"));
+	REQUIRE(written.find("Printed as an error.\n") != std::string_view::npos);
+	logging::console::get_instance().print_parallel("Buffered before print.", "LogConsole Single Threaded Example", logging::severity::info);
+	logging::console::print("Printed by print.", "LogConsole Single Threaded Example", logging::severity::info);
+	length = read(pipe_descriptors[0], buffer.data(), buffer.size());
+	REQUIRE(length > 0);
+	written = std::string_view(buffer.data(), length);
+	REQUIRE(written.find("Buffered before print.\n") < written.find("Printed by print.\n"));
+	REQUIRE(written.find("Printed by print.\n") != std::string_view::npos);
+#ifdef __linux__
+	// No child thread was started to print it.
+	auto tasks = std::filesystem::directory_iterator("/proc/self/task");
+	REQUIRE(std::distance(std::filesystem::begin(tasks), std::filesystem::end(tasks)) == 1);
+#endif
+
+	logging::init();
+	close(pipe_descriptors[1]);
+	close(pipe_descriptors[0]);
+}
+#endif
+
 TEST_CASE("Benchmark print_parallel console output.", "[benchmark][LogConsole][print_parallel]") {
 	BENCHMARK("Benchmark simple print_parallel.") {
 		return logging::console::get_instance().print_parallel(
@@ -187,6 +1086,62 @@ TEST_CASE("Benchmark print_parallel console output.", "[benchmark][LogConsole][p
 	};
 }
 
+TEST_CASE("Benchmark print_parallel_batch console output.", "[benchmark][LogConsole][print_parallel_batch]") {
+	std::vector<std::string> lines(100, "BenchmarkPrintParallelBatch1");
+	BENCHMARK("Benchmark print_parallel_batch of 100 messages.") {
+		return logging::console::get_instance().print_parallel_batch(
+			lines,
+			"LogConsole Print Parallel Batch Benchmark",
+			logging::severity::info
+		);
+	};
+}
+
+#ifndef _WIN32
+TEST_CASE("Benchmark print_parallel into queue shards.", "[benchmark][LogConsole][numa_shards]") {
+	// The console is constructed and its print thread runs on the first CPU, so a queue without shards is first 
+	// touched on that CPU's node, and the producer runs on the last CPU, which is on a different node of most 
+	// multi-socket machines.
+	int null_descriptor = open("/dev/null", O_WRONLY);
+	REQUIRE(null_descriptor >= 0);
+	logging::config configuration;
+	configuration.output_descriptor = null_descriptor;
+	configuration.print_thread.cpus = {0};
+	auto run_on_cpu = []([[maybe_unused]] unsigned int cpu, auto&& function) {
+#if defined(__linux__) && !defined(LOGGING_SINGLE_THREADED)
+		std::thread pinned([&] {
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			CPU_SET(cpu, &cpus);
+			pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+			function();
+		});
+		pinned.join();
+#else
+		function();
+#endif
+	};
+	unsigned int last_cpu = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+	for (bool numa_shards : {false, true}) {
+		configuration.numa_shards = numa_shards;
+		std::unique_ptr<logging::console> console;
+		run_on_cpu(0, [&] {
+			console = std::make_unique<logging::console>(configuration);
+		});
+		run_on_cpu(last_cpu, [&] {
+			BENCHMARK(numa_shards ? "Benchmark print_parallel into the producer's shard." : "Benchmark print_parallel into a queue on the first CPU's node.") {
+				return console->print_parallel(
+					"BenchmarkPrintParallelShard1",
+					"LogConsole NUMA Benchmark",
+					logging::severity::info
+				);
+			};
+		});
+	}
+	close(null_descriptor);
+}
+#endif
+
 
 
 /*************************************************************************************************/
@@ -225,3 +1180,328 @@ TEST_CASE("Print example exceptions.", "[test][LogException][format_message][exa
 		)
 	);
 }
+
+TEST_CASE("Check format_message allocates from a memory resource.", "[test][LogException][format_message]") {
+	std::array<std::byte, 4096> storage;
+	std::pmr::monotonic_buffer_resource resource(storage.data(), storage.size(), std::pmr::null_memory_resource());
+
+	std::pmr::string formatted = logging::exception::format_message(
+		&resource,
+		"Formatted into a memory resource\nOver two lines.",
+		"LogException Resource Example",
+		logging::severity::info
+	);
+	REQUIRE(formatted.get_allocator().resource() == &resource);
+	REQUIRE(formatted.find("(LogException Resource Example) Formatted into a memory resource\n") != std::pmr::string::npos);
+	REQUIRE(formatted.substr(formatted.length() - 16) == "Over two lines.\n");
+	REQUIRE_NOTHROW(std::cout << formatted);
+}
+
+TEST_CASE("Check format_message_to a caller provided buffer.", "[test][LogException][format_message_to]") {
+	const auto time = std::chrono::system_clock::now();
+	const std::string_view message = "Formatted into a fixed buffer\nOver two lines.";
+	const std::string_view name = "LogException Buffer Example";
+
+	// With no buffer, the length needed is still returned.
+	size_t needed = logging::exception::format_message_to(nullptr, 0, message, name, logging::severity::info, time);
+	std::array<char, 256> buffer;
+	REQUIRE(needed < buffer.size());
+
+	// A buffer large enough holds the whole message.
+	size_t length = logging::exception::format_message_to(buffer.data(), buffer.size(), message, name, logging::severity::info, time);
+	std::string_view formatted(buffer.data(), length);
+	REQUIRE(length == needed);
+	REQUIRE(formatted.find("(LogException Buffer Example) Formatted into a fixed buffer\n") != std::string_view::npos);
+	REQUIRE(formatted.substr(length - 16) == "Over two lines.\n");
+
+	// A buffer too small holds the start of the message, ending with the truncation marker.
+	std::array<char, 40> small_buffer;
+	length = logging::exception::format_message_to(small_buffer.data(), small_buffer.size(), message, name, logging::severity::info, time);
+	REQUIRE(length == needed);
+	REQUIRE(std::string_view(small_buffer.data(), small_buffer.size() - 4) == formatted.substr(0, small_buffer.size() - 4));
+	REQUIRE(std::string_view(small_buffer.data() + small_buffer.size() - 4, 4) == logging::exception::TRUNCATION_MARKER);
+
+	// The output iterator overload formats the same message.
+	std::string appended = "Prefix ";
+	logging::exception::format_message_to(std::back_inserter(appended), message, name, logging::severity::info);
+	REQUIRE(appended.find("(LogException Buffer Example) Formatted into a fixed buffer\n") != std::string::npos);
+	REQUIRE(appended.length() == 7 + needed);
+	REQUIRE_NOTHROW(std::cout << formatted);
+}
+
+TEST_CASE("Check error formats its message when what is called.", "[test][LogException][error]") {
+	logging::exception::error thrown(
+		"Formatted when it is read\nOver two lines.",
+		"LogException Error Example",
+		logging::severity::warning
+	);
+	REQUIRE(thrown.get_message() == "Formatted when it is read\nOver two lines.");
+	REQUIRE(thrown.get_name() == "LogException Error Example");
+	REQUIRE(thrown.get_severity() == logging::severity::warning);
+
+	// The message is formatted once, from any thread, and shared with copies of the exception.
+	const logging::exception::error copied = thrown;
+	std::array<const char*, 4> messages{};
+#ifndef LOGGING_SINGLE_THREADED
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < messages.size(); i++) {
+		threads.emplace_back([&messages, &copied, i]() { messages[i] = copied.what(); });
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+#else
+	for (const char*& message : messages) {
+		message = copied.what();
+	}
+#endif
+	for (const char* message : messages) {
+		REQUIRE(message == thrown.what());
+	}
+	std::string_view formatted = thrown.what();
+	REQUIRE(formatted.find("[WARNING]") != std::string_view::npos);
+	REQUIRE(formatted.find("(LogException Error Example) Formatted when it is read\n") != std::string_view::npos);
+
+	REQUIRE_THROWS_AS(throw thrown, std::runtime_error);
+	REQUIRE_NOTHROW(std::cout << thrown.what());
+}
+
+TEST_CASE("Print example exception chain.", "[test][LogException][format_exception_chain][example]") {
+	std::string formatted;
+	try {
+		try {
+			try {
+				throw std::runtime_error("The device did not respond.");
+			}
+			catch (...) {
+				std::throw_with_nested(logging::exception::error("Failed to read the block.\nRetried 3 times.", "LogException Disk Example"));
+			}
+		}
+		catch (...) {
+			std::throw_with_nested(logging::exception::error("Failed to load the file.", "LogException Loader Example", logging::severity::warning));
+		}
+	}
+	catch (const std::exception& caught) {
+		formatted = logging::exception::format_exception_chain(caught);
+	}
+
+	// Each cause is indented below the exception it caused.
+	size_t loader = formatted.find("[WARNING]  (LogException Loader Example) Failed to load the file.\n");
+	size_t disk = formatted.find("\n    [", loader);
+	size_t device = formatted.find("\n        [", disk);
+	REQUIRE(loader != std::string::npos);
+	REQUIRE(disk != std::string::npos);
+	REQUIRE(device != std::string::npos);
+	REQUIRE(formatted.find("(LogException Disk Example) Failed to read the block.\n", disk) < device);
+	REQUIRE(formatted.find("The device did not respond.\n", device) != std::string::npos);
+	REQUIRE(std::count(formatted.begin(), formatted.end(), '\n') == 4);
+	REQUIRE_NOTHROW(std::cout << formatted);
+}
+
+TEST_CASE("Check exceptions are passed to the exception hook with their throw site.", "[test][LogException][exception_hook]") {
+	static std::vector<logging::exception::throw_site> sites;
+	sites.clear();
+	logging::exception::set_exception_hook(
+		[](const logging::exception::throw_site& site, std::string_view, std::string_view, logging::severity) {
+			sites.push_back(site);
+		}
+	);
+
+	unsigned int format_line = __LINE__ + 1;
+	logging::exception::format_message("Passed to the hook.", "LogException Hook Example", logging::severity::warning);
+	unsigned int error_line = __LINE__ + 1;
+	logging::exception::error thrown("Passed to the hook.", "LogException Hook Example", logging::severity::warning);
+	logging::exception::set_exception_hook(nullptr);
+	logging::exception::format_message("Not passed to the hook.", "LogException Hook Example");
+
+	REQUIRE(sites.size() == 2);
+	REQUIRE(sites[0].line == format_line);
+	REQUIRE(std::string_view(sites[0].file).find("test_logging_tools.cpp") != std::string_view::npos);
+	REQUIRE(sites[0].type == nullptr);
+	REQUIRE(sites[1].line == error_line);
+	REQUIRE(*sites[1].type == typeid(logging::exception::error));
+}
+
+TEST_CASE("Print example logged exceptions.", "[test][LogConsole][LogException][exception_logging][example]") {
+	logging::console::enable_exception_logging(std::chrono::milliseconds(200), 2);
+
+	// Only the first two exceptions thrown from the loop are printed, then the rest are counted.
+	for (int i = 0; i < 10; i++) {
+		try {
+			throw logging::exception::error("Thrown in a loop " + std::to_string(i) + ".", "LogConsole Exception Example");
+		}
+		catch (const logging::exception::error&) {}
+	}
+	REQUIRE_NOTHROW(
+		logging::exception::format_message("Formatted once.", "LogConsole Exception Example", logging::severity::warning)
+	);
+
+	// Wait for the window to pass so the suppressed exceptions are counted.
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	logging::console::disable_exception_logging();
+	logging::console::flush();
+}
+
+#ifndef _WIN32
+TEST_CASE("Check repeated exceptions are suppressed by the throwing thread.", "[test][LogConsole][LogException][exception_logging]") {
+	// Sites are the same if their files have the same name, wherever the names are stored.
+	std::string file = __FILE__;
+	logging::exception::throw_site site{__FILE__, 1, &typeid(logging::exception::error)};
+	REQUIRE(site == logging::exception::throw_site{file.c_str(), 1, &typeid(logging::exception::error)});
+	REQUIRE_FALSE(site == logging::exception::throw_site{file.c_str(), 2, &typeid(logging::exception::error)});
+
+	int pipe_descriptors[2];
+	REQUIRE(pipe(pipe_descriptors) == 0);
+	logging::config configuration;
+	configuration.output_descriptor = pipe_descriptors[1];
+	configuration.external_drain = true;
+	logging::init(configuration);
+	logging::console::enable_exception_logging(std::chrono::seconds(10), 2);
+
+	// Only the exceptions admitted from the site are queued, and the rest are counted when the console stops.
+	for (int i = 0; i < 100; i++) {
+		try {
+			throw logging::exception::error("Thrown in a loop.", "LogConsole Exception Example");
+		}
+		catch (const logging::exception::error&) {}
+	}
+	REQUIRE(logging::console::get_instance().drain() == 2);
+	logging::console::disable_exception_logging();
+	logging::init();
+	close(pipe_descriptors[1]);
+	std::string written = read_all(pipe_descriptors[0]);
+	REQUIRE(count_occurrences(written, "Thrown in a loop.\n") == 2);
+	REQUIRE(written.find("Suppressed 98 repeats of the exception thrown at ") != std::string::npos);
+}
+#endif
+
+TEST_CASE("Benchmark format_message.", "[benchmark][LogException][format_message]") {
+	// Reference implementation of format_message that builds each message in a new stringstream, as it was 
+	// before messages were formatted into a stack buffer by format_message_to.
+	auto format_message_stringstream = [](const std::string& message, const std::string& name, logging::severity severity) {
+		std::string timestamp = logging::generate_timestamp();
+		std::deque<std::string> message_lines = logging::split_string(message, "\n");
+		std::stringstream ss;
+		ss 	<< std::left 
+			<< "[" << std::setw(logging::time_template_width) << timestamp + "]" 
+			<< "[" << std::setw(logging::Severity::get_max_severity_length() + 2) << std::string(logging::Severity(severity)) + "]" 
+			<< "(" << std::string(name) + ") ";
+		std::string line = message_lines.front();
+		message_lines.pop_front();
+		size_t preamble_width = ss.str().length();
+		ss << line + "\n";
+		while (!message_lines.empty()) {
+			line = message_lines.front();
+			message_lines.pop_front();
+			ss << std::setw(preamble_width) << " " << line + "\n";
+		}
+		return ss.str();
+	};
+
+	BENCHMARK("Benchmark format_message with a stringstream per call (before).") {
+		return format_message_stringstream(
+			"BenchmarkFormatMessage1\nOver two lines.",
+			"LogException Format Message Benchmark",
+			logging::severity::error
+		);
+	};
+
+	BENCHMARK("Benchmark format_message formatted into a stack buffer (after).") {
+		return logging::exception::format_message(
+			"BenchmarkFormatMessage1\nOver two lines.",
+			"LogException Format Message Benchmark",
+			logging::severity::error
+		);
+	};
+
+	BENCHMARK("Benchmark format_message_to a caller provided buffer.") {
+		std::array<char, 256> buffer;
+		return logging::exception::format_message_to(
+			buffer.data(),
+			buffer.size(),
+			"BenchmarkFormatMessage1\nOver two lines.",
+			"LogException Format Message Benchmark",
+			logging::severity::error
+		);
+	};
+
+	BENCHMARK("Benchmark throwing and catching a formatted runtime_error.") {
+		char first = '\0';
+		try {
+			throw std::runtime_error(logging::exception::format_message(
+				"BenchmarkFormatMessage1\nOver two lines.",
+				"LogException Format Message Benchmark",
+				logging::severity::error
+			));
+		}
+		catch (const std::exception& caught) {
+			first = caught.what()[0];
+		}
+		return first;
+	};
+
+	BENCHMARK("Benchmark throwing and catching an error without reading it.") {
+		char first = '\0';
+		try {
+			throw logging::exception::error(
+				"BenchmarkFormatMessage1\nOver two lines.",
+				"LogException Format Message Benchmark",
+				logging::severity::error
+			);
+		}
+		catch (const logging::exception::error& caught) {
+			first = caught.get_message()[0];
+		}
+		return first;
+	};
+}
+
+/*************************************************************************************************/
+/* LogStackTrace Tests																			 */
+/*************************************************************************************************/
+TEST_CASE("Check stack traces are captured and named.", "[test][LogStackTrace]") {
+	std::array<void*, logging::stack_trace::MAX_FRAMES> frames;
+	size_t frame_count = logging::stack_trace::capture(frames.data(), frames.size());
+	REQUIRE(frame_count > 0);
+
+	// Each address is named once, then the cached name is returned.
+	std::string_view symbol = logging::stack_trace::get_symbol(frames[0]);
+	REQUIRE(!symbol.empty());
+	REQUIRE(logging::stack_trace::get_symbol(frames[0]).data() == symbol.data());
+
+	REQUIRE(!logging::stack_trace::should_capture(logging::severity::error));
+	logging::stack_trace::enable_capture(logging::severity::warning);
+	REQUIRE(logging::stack_trace::should_capture(logging::severity::warning));
+	REQUIRE(!logging::stack_trace::should_capture(logging::severity::info));
+
+	// Exceptions and console messages of the severity are followed by their trace.
+	logging::exception::error thrown("Followed by a stack trace.", "LogStackTrace Example", logging::severity::warning);
+	std::string_view formatted = thrown.what();
+	REQUIRE(formatted.find("Followed by a stack trace.\n") != std::string_view::npos);
+	REQUIRE(formatted.find("    at ") != std::string_view::npos);
+	REQUIRE_NOTHROW(std::cout << formatted);
+	REQUIRE_NOTHROW(logging::console::print("Printed with a stack trace.", "LogStackTrace Example", logging::severity::warning));
+	REQUIRE_NOTHROW(logging::console::get_instance().print_parallel("Printed in parallel with a stack trace.", "LogStackTrace Example", logging::severity::error));
+	REQUIRE_NOTHROW(logging::console::get_instance().print_parallel("Printed without a stack trace.", "LogStackTrace Example", logging::severity::info));
+	logging::console::get_instance().flush();
+
+	logging::stack_trace::disable_capture();
+	REQUIRE(!logging::stack_trace::should_capture(logging::severity::error));
+}
+
+TEST_CASE("Benchmark stack trace capture.", "[benchmark][LogStackTrace]") {
+	std::array<void*, logging::stack_trace::MAX_FRAMES> frames;
+	size_t frame_count = logging::stack_trace::capture(frames.data(), frames.size());
+
+	BENCHMARK("Benchmark capturing a stack trace.") {
+		return logging::stack_trace::capture(frames.data(), frames.size());
+	};
+
+	BENCHMARK("Benchmark naming the frames of a stack trace from the cache.") {
+		size_t length = 0;
+		for (size_t i = 0; i < frame_count; i++) {
+			length += logging::stack_trace::get_symbol(frames[i]).length();
+		}
+		return length;
+	};
+}